@@ -10,272 +10,1764 @@ The main interface module source for a task on the topic of code generation.
 #include "pch.h"
 #include "CodegenAPI.h"
 
+#include <cstring>
 #include <string_view>
 #include <queue>
+#include <unordered_map>
+#include <unordered_set>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
 
 using namespace CodegenAPI;
 using namespace std;
 
+//the marks of names for one generation, they are cleared at once by moving to the next epoch,
+//so a generation costs nothing for the names of the scheme it does not reach
+class NameMarks
+{
+protected:
+    vector<uint32_t> m_epochs;
+    vector<NameId> m_values;
+    uint32_t m_epoch = 0;
+public:
+    void reset(size_t size)
+    {
+        if(m_epochs.size()<size){ m_epochs.resize(size); m_values.resize(size); }
+        if(++m_epoch==0){ fill(begin(m_epochs),end(m_epochs),0); m_epoch = 1; }
+    }
+    bool test(NameId id) const { return m_epochs[id]==m_epoch; }
+    NameId value(NameId id) const { return test(id) ? m_values[id] : NoName; }
+    void set(NameId id, NameId value = 0) { m_epochs[id] = m_epoch; m_values[id] = value; }
+};
+
+//the types of a generator for the checks, the ordered scheme is built for the kinds which ask for it
+class SchemeLookup : public TypeLookup
+{
+protected:
+    const Codegen &m_codegen;
+public:
+    explicit SchemeLookup(const Codegen &codegen) : m_codegen(codegen) { }
+
+    const TypeInfo* find(string_view keyname) const override { return m_codegen.findType(keyname); }
+    const map<LongName,shared_ptr<TypeInfo>>& scheme() const override { return m_codegen.getSheme(); }
+};
+
+
+
+InternedScheme::InternedScheme(const map<LongName,shared_ptr<TypeInfo>> &scheme,
+    const set<LongName> &applied, shared_ptr<NameTable> names) : m_names(move(names))
+{
+    m_names->reserve(m_names->size()+2*scheme.size());
+    for(const auto & [keyname, info] : scheme)assign(keyname,info.get());
+    apply(applied);
+}
+
+InternedScheme::InternedScheme(const vector<pair<string_view,TypeInfo*>> &scheme,
+    const set<LongName> &applied, shared_ptr<const SchemeArena> arena) : m_names(make_shared<NameTable>())
+{
+    m_names->reserve(2*scheme.size());
+    for(const auto & [keyname, info] : scheme)bind(keyname,info,arena.get());
+    m_names->keep(move(arena));
+    apply(applied);
+}
+
+void InternedScheme::apply(const set<LongName> &applied)
+{
+    for(const LongName &name : applied)m_names->intern(name);
+    grow();
+    for(const LongName &name : applied)m_applied[m_names->find(name)] = true;
+}
+
+void InternedScheme::grow()
+{
+    m_infos.resize(m_names->size()); m_modules.resize(m_names->size(),NoName);
+    m_depend_ranges.resize(m_names->size()); m_applied.resize(m_names->size());
+}
+
+void InternedScheme::compact()
+{
+    vector<NameId> edges; edges.reserve(m_depend_edges.size()-m_dropped_edges);
+    for(auto &[first, count] : m_depend_ranges)
+    {
+        edges.insert(end(edges),begin(m_depend_edges)+first,begin(m_depend_edges)+first+count);
+        first = static_cast<uint32_t>(edges.size()-count);
+    }
+    m_depend_edges.swap(edges); m_dropped_edges = 0;
+}
+
+void InternedScheme::detach()
+{
+    if(!m_snapshot)return;
+    //the decoded types stay owned by the snapshot, which the name table keeps alive
+    shared_ptr<const Snapshot> snapshot; snapshot.swap(m_snapshot);
+    m_infos.resize(snapshot->size()); m_modules.resize(snapshot->size());
+    m_depend_ranges.resize(snapshot->size()); m_applied.resize(snapshot->size());
+    for(NameId id = 0; id<snapshot->size(); ++id)
+    {
+        Span<NameId> depends = snapshot->dependencies(id);
+        m_infos[id] = snapshot->info(id); m_modules[id] = snapshot->module(id);
+        m_depend_ranges[id] = {static_cast<uint32_t>(m_depend_edges.size()),static_cast<uint32_t>(depends.size())};
+        m_depend_edges.insert(end(m_depend_edges),begin(depends),end(depends));
+        m_applied[id] = snapshot->isApplied(id);
+    }
+}
+
+NameTable& InternedScheme::ownNames()
+{
+    //the readers of the other owners keep the old table, the identifiers stay the same in the copy
+    if(m_names.use_count()>1)m_names = make_shared<NameTable>(*m_names);
+    return *m_names;
+}
+
+NameId InternedScheme::bind(string_view keyname, const TypeInfo *info, const SchemeArena *arena)
+{
+    detach();
+    NameTable &names = ownNames();
+    NameId id = arena ? names.borrow(keyname) : names.intern(keyname);
+
+    //namespaces of the key are interned by their full path
+    for(size_t pos = keyname.find("::"); pos!=string_view::npos; pos = keyname.find("::",pos+2))
+        if(arena)names.borrow(keyname.substr(0,pos)); else names.intern(keyname.substr(0,pos));
+
+    //the dependencies of all keys are kept in one edge array, the replaced ones are dropped
+    size_t first = m_depend_edges.size();
+    if(info)for(const LongName &depname : info->dependencies())
+    {
+        const LongName *kept = arena ? arena->kept(depname) : nullptr;
+        m_depend_edges.push_back(kept ? names.borrow(*kept) : names.intern(depname));
+    }
+    NameId module = info && info->isExternal() ? names.intern(info->getModule().view()) : NoName;
+
+    grow();
+    m_dropped_edges += m_depend_ranges[id].second;
+    m_infos[id] = info; m_modules[id] = module;
+    m_depend_ranges[id] = {static_cast<uint32_t>(first),static_cast<uint32_t>(m_depend_edges.size()-first)};
+    if(m_dropped_edges>m_depend_edges.size()/2)compact();
+    return id;
+}
+
+void InternedScheme::setModuleGraph(const ModuleGraph &graph)
+{
+    m_module_includes.clear();
+    NameTable &names = ownNames();
+    for(const auto & [module, includes] : graph.entries())
+    {
+        vector<NameId> &edges = m_module_includes[names.intern(module.view())];
+        for(const ModuleName &included : includes)edges.push_back(names.intern(included.view()));
+    }
+}
+
+
+
+NameId IntermediateCode::intern(string_view name)
+{
+    if(NameId id = m_names->find(name); id!=NoName)return id;
+    if(!m_own_names){ m_names = make_shared<NameTable>(*m_names); m_own_names = true; }
+    return m_names->intern(name);
+}
+
 void IntermediateCode::includeModule(const ModuleName &mname)
 { 
-    if(mname.isPerfect())
-        m_code.push_back({Command::IncludeModule,mname.view()}); 
+    if(mname.isPerfect())includeModule(intern(mname.view())); 
+}
+
+void IntermediateCode::openNamespace(const string &name)
+{
+    if(m_spaces.empty())openNamespace(intern(name));
+    else openNamespace(intern(string(m_names->view(m_spaces.back()))+"::"+name));
+}
+
+void IntermediateCode::declareForward(const string &name)
+{
+    if(m_spaces.empty())declareForward(intern(name));
+    else declareForward(intern(string(m_names->view(m_spaces.back()))+"::"+name));
+}
+
+void IntermediateCode::push(Command command, NameId operand)
+{
+    if(operand>OperandMask)throw length_error("the name identifier exceeds the command operand");
+    m_code.push_back(static_cast<uint32_t>(command)<<OperandBits | operand);
+}
+
+void IntermediateCode::includeModule(NameId mname)
+    { push(Command::IncludeModule,mname); }
+
+void IntermediateCode::openNamespace(NameId space)
+    { push(Command::OpenNamespace,space); m_spaces.push_back(space); }
+
+void IntermediateCode::declareForward(NameId keyname)
+    { push(Command::ForwardDeclaration,keyname); }
+
+void IntermediateCode::closeNamespace()
+{ 
+    if(!m_spaces.empty())m_spaces.pop_back();
+    if(!m_code.empty() && opcode(m_code.back())==Command::OpenNamespace)
+        m_code.pop_back();
+    else push(Command::CloseNamespace); 
+}
+
+bool IntermediateCode::operator==(const IntermediateCode &other) const
+{
+    if(m_code.size()!=other.m_code.size())return false;
+    if(m_names==other.m_names)return m_code==other.m_code;
+    for(size_t i=0; i<m_code.size(); ++i)
+        if(opcode(m_code[i])!=opcode(other.m_code[i]) || (opcode(m_code[i])!=Command::CloseNamespace &&
+                m_names->view(operand(m_code[i]))!=other.m_names->view(operand(other.m_code[i]))))
+            return false;
+    return true;
+}
+
+//the name relative to the enclosing namespace, the result refers to the interned string;
+//a namespace may have an empty name, as the leading one of '::a'
+static string_view relativeName(string_view name, string_view deepname, bool space = false)
+{
+    if(name.size()+(space ? 1 : 0)<=deepname.size() || name.compare(0,deepname.size(),deepname)!=0)
+        throw NamespaceNestingError();
+    return name.substr(deepname.size());
+}
+
+//the scheme passed by the map is interned for every call
+static InternedScheme internScheme(const map<LongName,shared_ptr<TypeInfo>> &scheme,
+    const set<LongName> &applied, const NameTable &names, CodegenStats *stats)
+{
+    CodegenStats::Scope scope(stats,CodegenStats::Phase::Interning);
+    return InternedScheme(scheme,applied,make_shared<NameTable>(names));
+}
+
+string IntermediateCode::translate(const map<LongName,shared_ptr<TypeInfo>> &scheme, CodegenStats *stats) const
+    { return translate(internScheme(scheme,{},*m_names,stats),stats); }
+
+void IntermediateCode::translate(OutputSink &sink, const map<LongName,shared_ptr<TypeInfo>> &scheme,
+    CodegenStats *stats) const
+    { translate(sink,internScheme(scheme,{},*m_names,stats),stats); }
+
+vector<LongName> IntermediateCode::forwardNames() const
+{
+    vector<LongName> names;
+    for(uint32_t word : m_code)
+        if(opcode(word)==Command::ForwardDeclaration)names.emplace_back(m_names->view(operand(word)));
+    return names;
+}
+
+string IntermediateCode::translate(SchemeResolver &resolver, CodegenStats *stats) const
+    { return translate(resolver.closure(forwardNames(),{}),stats); }
+
+void IntermediateCode::translate(OutputSink &sink, SchemeResolver &resolver, CodegenStats *stats) const
+    { translate(sink,resolver.closure(forwardNames(),{}),stats); }
+
+bool IntermediateCode::verify(SchemeResolver &resolver,
+    const vector<LongName> &include_names, const vector<LongName> &declare_names,
+    const set<LongName> &applied, CodegenStats *stats) const
+{
+    vector<LongName> names = forwardNames();
+    names.insert(names.end(),include_names.begin(),include_names.end());
+    names.insert(names.end(),declare_names.begin(),declare_names.end());
+    return verify(resolver.closure(names,applied),include_names,declare_names,applied,stats);
+}
+
+//writes the text of the commands as they come, the translation of the intermediate code
+//replays its commands into the writer and the fused generation renders into it directly
+class SourceWriter
+{
+protected:
+    OutputSink &m_sink;
+    const NameTable &m_names;
+    const InternedScheme &m_scheme;
+    vector<string> m_deepname;
+    string m_name;
+    size_t m_size;
+    bool m_force_endl;
+
+    OutputSink& skip()
+    {
+        if(m_force_endl){ m_sink<<'\n'; m_force_endl = false; }
+        return m_sink.fill('\t',m_deepname.size()-1);
+    }
+public:
+    SourceWriter(OutputSink &sink, const NameTable &names, const InternedScheme &scheme)
+        : m_sink(sink), m_names(names), m_scheme(scheme), m_deepname(1), m_size(), m_force_endl(false) { }
+
+    size_t size() const { return m_size; }
+
+    void includeModule(NameId mname)
+        { ++m_size; m_sink<<"#include "<<m_names.view(mname)<<'\n'; m_force_endl = true; }
+    void openNamespace(NameId space)
+    {
+        string_view name = m_names.view(space); ++m_size;
+        skip()<<"namespace "<<relativeName(name,m_deepname.back(),true)<<'\n';
+        skip()<<"{\n";
+        m_deepname.push_back(string(name)+"::");
+    }
+    void declareForward(NameId keyname)
+    {
+        //the relative name of a forward is built in one reused buffer
+        string_view name = m_names.view(keyname); ++m_size;
+        const TypeInfo *info = m_scheme.info(keyname);
+        if(!info)throw NotFoundKeyError(string(name));
+        m_name.assign(relativeName(name,m_deepname.back()));
+        info->translate(skip(),m_deepname.back(),m_name);
+    }
+    void closeNamespace()
+    {
+        m_deepname.pop_back(); if(m_deepname.empty())throw NamespaceNestingError();
+        ++m_size; skip()<<"}\n";
+    }
+};
+
+//checks the commands as they come, the completed forwards, the forced names and the included
+//modules are dense marks over the name identifiers cleared by the epoch, so a check costs
+//constant work per command and per dependency whatever the size of the scheme;
+//one verifier at a time is served by the marks of a thread
+class CodeVerifier
+{
+protected:
+    const InternedScheme &m_scheme;
+    const NameTable &m_names;
+    NameMarks &m_completed;
+    NameMarks &m_forced_declare;
+    NameMarks &m_modules;
+    Diagnostics *m_diagnostics;
+    size_t m_indent;
+    size_t m_size;
+
+    bool completed(NameId id) const { return m_scheme.isApplied(id) || m_completed.test(id); }
+    static NameMarks& marks(size_t index)
+        { static thread_local NameMarks marks[3]; return marks[index]; }
+    template <class Error> void report(DiagnosticKind kind, string_view name, Error error) const
+        { Diagnostics::report(m_diagnostics,kind,name,move(error)); }
+public:
+    //without the diagnostics the first wrong command throws its error
+    CodeVerifier(const InternedScheme &scheme, const NameTable &names, const vector<LongName> &declare_names,
+        Diagnostics *diagnostics = nullptr)
+        : m_scheme(scheme), m_names(names), m_completed(marks(0)), m_forced_declare(marks(1)),
+        m_modules(marks(2)), m_diagnostics(diagnostics), m_indent(), m_size()
+    {
+        size_t size = max(scheme.size(),names.size());
+        m_completed.reset(size); m_forced_declare.reset(size); m_modules.reset(size);
+        for(const LongName &keyname : declare_names)
+            if(NameId id = scheme.find(keyname); id!=NoName)m_forced_declare.set(id);
+    }
+
+    size_t size() const { return m_size; }
+    //the name is declared by an included header
+    void assume(NameId keyname) { m_completed.set(keyname); }
+
+    //the modules included by the module are covered by it
+    void includeModule(NameId mname)
+    {
+        ++m_size;
+        if(m_modules.test(mname))return;
+        m_modules.set(mname);
+        if(!m_scheme.hasModuleGraph())return;
+        vector<NameId> pending{mname};
+        while(!pending.empty())
+        {
+            NameId module = pending.back(); pending.pop_back();
+            for(NameId included : m_scheme.moduleIncludes(module))
+                if(!m_modules.test(included)){ m_modules.set(included); pending.push_back(included); }
+        }
+    }
+    void openNamespace(NameId) { ++m_size; ++m_indent; }
+    void declareForward(NameId keyname)
+    {
+        ++m_size;
+        const TypeInfo *info = m_scheme.info(keyname);
+        string_view name = m_names.view(keyname);
+        if(!info)return report(DiagnosticKind::NotFoundKey,name,NotFoundKeyError(string(name)));
+
+        //check for double forward
+        if(completed(keyname))return report(DiagnosticKind::DuplicateForward,name,DuplicateForwardError(string(name)));
+        m_completed.set(keyname);
+
+        //check for module include
+        if(info->isExternal() && !m_modules.test(m_scheme.module(keyname)))
+            report(DiagnosticKind::NotFoundModule,info->getModule().view(),NotFoundModuleError(info->getModule().view()));
+
+        //check dependencies for forward and/or include
+        for(NameId depname : m_scheme.dependencies(keyname))
+            if(!completed(depname))
+            {
+                string depview(m_scheme.view(depname));
+                if(m_forced_declare.test(depname))
+                    { report(DiagnosticKind::NotFoundForward,depview,NotFoundForwardError(depview)); continue; }
+                const TypeInfo *depinfo = m_scheme.info(depname);
+                if(!depinfo)report(DiagnosticKind::NotFoundKey,depview,NotFoundKeyError(depview));
+                else if(!depinfo->isExternal())report(DiagnosticKind::NotFoundForward,depview,NotFoundForwardError(depview));
+                else if(!m_modules.test(m_scheme.module(depname)))
+                    report(DiagnosticKind::NotFoundModule,depinfo->getModule().view(),
+                        NotFoundModuleError(depinfo->getModule().view()));
+            }
+    }
+    void closeNamespace()
+    {
+        ++m_size;
+        if(m_indent==0)return report(DiagnosticKind::NamespaceNesting,string_view(),NamespaceNestingError());
+        --m_indent;
+    }
+
+    void finish(const vector<LongName> &include_names, const vector<LongName> &declare_names) const
+    {
+        //check namespace hierarchy
+        if(m_indent!=0)report(DiagnosticKind::NamespaceNesting,string_view(),NamespaceNestingError());
+
+        //check for include forced names
+        for(const LongName &keyname : include_names)
+            if(NameId id = m_scheme.find(keyname); !m_scheme.info(id))
+                report(DiagnosticKind::NotFoundKey,keyname,NotFoundKeyError(keyname));
+            else if(NameId mname = m_scheme.module(id); mname==NoName || !m_modules.test(mname))
+                report(DiagnosticKind::NotFoundModule,m_scheme.info(id)->getModule().view(),
+                    NotFoundModuleError(m_scheme.info(id)->getModule().view()));
+
+        //check for forward forced names
+        for(const LongName &keyname : declare_names)
+            if(NameId id = m_scheme.find(keyname); id==NoName || !completed(id))
+                report(DiagnosticKind::NotFoundForward,keyname,NotFoundForwardError(keyname));
+    }
+};
+
+//passes the commands to the target and checks them on the way
+template <class Target> class VerifiedTarget : public CodeVerifier
+{
+protected:
+    Target &m_target;
+public:
+    VerifiedTarget(Target &target, const InternedScheme &scheme, const NameTable &names,
+        const vector<LongName> &declare_names, Diagnostics *diagnostics = nullptr)
+        : CodeVerifier(scheme,names,declare_names,diagnostics), m_target(target) { }
+
+    size_t size() const { return m_target.size(); }
+
+    void includeModule(NameId mname) { CodeVerifier::includeModule(mname); m_target.includeModule(mname); }
+    void openNamespace(NameId space) { CodeVerifier::openNamespace(space); m_target.openNamespace(space); }
+    void declareForward(NameId keyname) { CodeVerifier::declareForward(keyname); m_target.declareForward(keyname); }
+    void closeNamespace() { CodeVerifier::closeNamespace(); m_target.closeNamespace(); }
+};
+
+//writes the text of the commands in place, every command is sized exactly before it is written,
+//so the buffer grows ahead of the text and never by appends; a forward is written by its type
+//within the size it reports, the name of a forward starts with its namespace, so the namespace
+//is passed to the type as a part of the name
+class TextWriter
+{
+protected:
+    const NameTable &m_names;
+    const InternedScheme &m_scheme;
+    string &m_buffer;
+    vector<string_view> m_spaces;
+    size_t m_used;
+    size_t m_size;
+    bool m_force_endl;
+
+    char* reserve(size_t bytes)
+    {
+        if(m_buffer.size()-m_used<bytes)m_buffer.resize(max(2*m_buffer.size(),m_used+bytes));
+        return m_buffer.data()+m_used;
+    }
+    static char* put(char *text, string_view part) { memcpy(text,part.data(),part.size()); return text+part.size(); }
+    size_t indentSize() const { return m_spaces.size()-1+(m_force_endl ? 1 : 0); }
+    char* indent(char *text)
+    {
+        if(m_force_endl){ *text++ = '\n'; m_force_endl = false; }
+        memset(text,'\t',m_spaces.size()-1); return text+m_spaces.size()-1;
+    }
+    //the root is told by the depth, a namespace may have an empty name
+    size_t deepSize() const { return m_spaces.size()==1 ? 0 : m_spaces.back().size()+2; }
+    string_view relativeName(string_view name, bool space = false) const
+    {
+        string_view enclosing = m_spaces.back();
+        if((m_spaces.size()>1 && (name.size()<enclosing.size()+2 || name.compare(0,enclosing.size(),enclosing)!=0 ||
+                name.compare(enclosing.size(),2,"::")!=0)) || (!space && name.size()==deepSize()))
+            throw NamespaceNestingError();
+        return name.substr(deepSize());
+    }
+public:
+    //the text is written over the buffer from its start
+    TextWriter(string &buffer, const NameTable &names, const InternedScheme &scheme)
+        : m_names(names), m_scheme(scheme), m_buffer(buffer), m_spaces(1), m_used(), m_size(), m_force_endl(false) { }
+
+    size_t size() const { return m_size; }
+    string_view text() const { return string_view(m_buffer.data(),m_used); }
+
+    //"#include ", "namespace " and the lines of the braces
+    void includeModule(NameId mname)
+    {
+        string_view name = m_names.view(mname);
+        char *text = put(put(reserve(10+name.size()),"#include "),name); *text++ = '\n';
+        m_used += 10+name.size(); ++m_size; m_force_endl = true;
+    }
+    void openNamespace(NameId space)
+    {
+        string_view name = m_names.view(space), relative = relativeName(name,true);
+        size_t bytes = 2*indentSize()+11+relative.size()+2-(m_force_endl ? 1 : 0);
+        char *text = put(put(indent(reserve(bytes)),"namespace "),relative); *text++ = '\n';
+        put(indent(text),"{\n");
+        m_used += bytes; ++m_size; m_spaces.push_back(name);
+    }
+    void declareForward(NameId keyname)
+    {
+        string_view name = m_names.view(keyname), relative = relativeName(name);
+        string_view key = name.substr(0,name.size()-relative.size());
+        const TypeInfo *info = m_scheme.info(keyname);
+        if(!info)throw NotFoundKeyError(string(name));
+        size_t size = info->translatedSize(key,relative), bytes = indentSize()+size;
+        char *text = indent(reserve(bytes));
+        if(info->translate(text,key,relative)!=text+size)throw OutputError("the size of "+string(name));
+        m_used += bytes; ++m_size;
+    }
+    void closeNamespace()
+    {
+        m_spaces.pop_back(); if(m_spaces.empty())throw NamespaceNestingError();
+        size_t bytes = indentSize()+2;
+        put(indent(reserve(bytes)),"}\n"); m_used += bytes; ++m_size;
+    }
+};
+
+//a buffer kept by a thread for its next call is released when a large text has grown it past the limit
+static constexpr size_t RetainedBufferSize = size_t(1)<<20;
+
+static void releaseLarge(string &buffer)
+{
+    if(buffer.capacity()<=RetainedBufferSize)return;
+    buffer.clear(); buffer.shrink_to_fit();
+}
+
+//the text of the commands in one allocation of its exact size, the buffer the text is written
+//over is reused by the thread
+template <class Source> static string writeText(const Source &source, const NameTable &names,
+    const InternedScheme &scheme)
+{
+    static thread_local string buffer;
+    TextWriter writer(buffer,names,scheme);
+    source(writer);
+    string text(writer.text());
+    releaseLarge(buffer);
+    return text;
+}
+
+//the text of a shard, the includes of the shards it depends on follow the modules
+class ShardWriter : public SourceWriter
+{
+protected:
+    vector<string> m_shards;
+
+    void includeShards()
+    {
+        if(m_shards.empty())return;
+        for(const string &shard : m_shards)m_sink<<"#include "<<ModuleName(shard).view()<<'\n';
+        m_shards.clear(); m_force_endl = true;
+    }
+public:
+    ShardWriter(OutputSink &sink, const NameTable &names, const InternedScheme &scheme, vector<string> shards)
+        : SourceWriter(sink,names,scheme), m_shards(move(shards)) { m_sink<<"#pragma once\n"; }
+
+    void openNamespace(NameId space) { includeShards(); SourceWriter::openNamespace(space); }
+    void declareForward(NameId keyname) { includeShards(); SourceWriter::declareForward(keyname); }
+    void finish() { includeShards(); m_sink.flush(); }
+};
+
+template <class Target> void IntermediateCode::replay(Target &target) const
+{
+    for(uint32_t word : m_code)switch(opcode(word))
+    {
+    case Command::IncludeModule: target.includeModule(operand(word)); break;
+    case Command::OpenNamespace: target.openNamespace(operand(word)); break;
+    case Command::ForwardDeclaration: target.declareForward(operand(word)); break;
+    case Command::CloseNamespace: target.closeNamespace(); break;
+    default: throw bad_exception();
+    }
+}
+
+void IntermediateCode::translate(OutputSink &sink, const InternedScheme &scheme, CodegenStats *stats) const
+{
+    CodegenStats::Scope scope(stats,CodegenStats::Phase::Translation);
+    if(stats)stats->notePeakCodeSize(m_code.size());
+    SourceWriter writer(sink,*m_names,scheme);
+    replay(writer);
+    sink.flush();
+}
+
+string IntermediateCode::translate(const InternedScheme &scheme, CodegenStats *stats) const
+{
+    CodegenStats::Scope scope(stats,CodegenStats::Phase::Translation);
+    if(stats)stats->notePeakCodeSize(m_code.size());
+    return writeText([this](TextWriter &writer) { replay(writer); },*m_names,scheme);
+}
+
+bool IntermediateCode::verify(
+    const map<LongName,shared_ptr<TypeInfo>> &scheme,
+    const vector<LongName> &include_names, const vector<LongName> &declare_names,
+    const set<LongName> &applied, CodegenStats *stats) const
+{
+    return verify(internScheme(scheme,applied,*m_names,stats),include_names,declare_names,stats);
+}
+
+bool IntermediateCode::verify(
+    const map<LongName,shared_ptr<TypeInfo>> &scheme,
+    const vector<LongName> &include_names, const vector<LongName> &declare_names,
+    const set<LongName> &applied, const ModuleGraph &modules, CodegenStats *stats) const
+{
+    InternedScheme interned = internScheme(scheme,applied,*m_names,stats);
+    interned.setModuleGraph(modules);
+    return verify(interned,include_names,declare_names,stats);
+}
+
+Diagnostics IntermediateCode::diagnose(
+    const map<LongName,shared_ptr<TypeInfo>> &scheme,
+    const vector<LongName> &include_names, const vector<LongName> &declare_names,
+    const set<LongName> &applied, CodegenStats *stats) const
+{
+    Diagnostics diagnostics;
+    verify(internScheme(scheme,applied,*m_names,stats),include_names,declare_names,stats,&diagnostics);
+    return diagnostics;
+}
+
+Diagnostics IntermediateCode::diagnose(
+    const map<LongName,shared_ptr<TypeInfo>> &scheme,
+    const vector<LongName> &include_names, const vector<LongName> &declare_names,
+    const set<LongName> &applied, const ModuleGraph &modules, CodegenStats *stats) const
+{
+    Diagnostics diagnostics;
+    InternedScheme interned = internScheme(scheme,applied,*m_names,stats);
+    interned.setModuleGraph(modules);
+    verify(interned,include_names,declare_names,stats,&diagnostics);
+    return diagnostics;
+}
+
+bool IntermediateCode::verify(const InternedScheme &scheme,
+    const vector<LongName> &include_names, const vector<LongName> &declare_names,
+    CodegenStats *stats, Diagnostics *diagnostics) const
+{
+    CodegenStats::Scope scope(stats,CodegenStats::Phase::Verification);
+    if(stats)
+    {
+        stats->notePeakCodeSize(m_code.size());
+        stats->counters().lookups += 2*declare_names.size()+2*include_names.size();
+    }
+    CodeVerifier verifier(scheme,*m_names,declare_names,diagnostics);
+    replay(verifier);
+    verifier.finish(include_names,declare_names);
+    return !diagnostics || diagnostics->empty();
+}
+
+
+
+static unsigned countTrailingZeros(uint64_t word)
+{
+#if defined(_MSC_VER)
+    unsigned long index; _BitScanForward64(&index,word); return static_cast<unsigned>(index);
+#else
+    return static_cast<unsigned>(__builtin_ctzll(word));
+#endif
+}
+
+//the scheduling state of the namespaces reached by one generation over the namespace index;
+//the state of a namespace is reset by its first touch in the epoch and the storage
+//is kept by the thread for the next generations
+struct Codegen::NamespaceSchedule
+{
+    using NodeId = NamespaceIndex::NodeId;
+    struct NodeState
+    {
+        uint32_t epoch = 0;
+        size_t ready_count;
+        size_t iterations;
+        //the ranks of the ready forwards, the first in the name order on the top
+        vector<uint32_t> ready_forwards;
+    };
+
+    struct Storage
+    {
+        vector<NodeState> states;
+        vector<uint64_t> ready_nodes;
+        vector<NodeId> touched;
+        uint32_t epoch = 0;
+    };
+    static Storage& storage() { static thread_local Storage storage; return storage; }
+
+    const NamespaceIndex &index;
+    vector<NodeState> &states;
+    //a namespace with ready forwards below it is marked for its parent
+    vector<uint64_t> &ready_nodes;
+    vector<NodeId> &touched;
+    uint32_t epoch;
+
+    explicit NamespaceSchedule(const NamespaceIndex &index);
+
+    void place(NodeId node);
+    void markReady(NodeId node, uint32_t rank);
+    NodeId nextReady(NodeId first, NodeId last) const;
+    template <class Target> void renderNode(Target &code, ForwardGraph &graph, NodeId node);
+    void report(CodegenStats &stats, const InternedScheme &scheme) const;
+};
+
+struct Codegen::ForwardGraph
+{
+    const InternedScheme &scheme;
+    const vector<NameId> &forwards;
+    const NameMarks &local;
+    const NameMarks &forced_declare;
+    NamespaceSchedule &schedule;
+
+    //forwards blocked by each forward, indexed by the position in 'forwards'
+    vector<size_t> offsets;
+    vector<size_t> blocked;
+    vector<size_t> pending;
+    size_t emitted;
+    size_t opened;
+
+    ForwardGraph(const InternedScheme &scheme, const vector<NameId> &forwards,
+        const NameMarks &local, const NameMarks &forced_declare, NamespaceSchedule &schedule);
+
+    bool blocks(NameId keyname, NameId depname) const;
+    void start();
+    template <class Target> void emit(Target &code, NameId keyname);
+    vector<LongName> findLoop() const;
+};
+
+Codegen::ForwardGraph::ForwardGraph(const InternedScheme &scheme, const vector<NameId> &forwards,
+    const NameMarks &local, const NameMarks &forced_declare, NamespaceSchedule &schedule)
+    : scheme(scheme), forwards(forwards), local(local), forced_declare(forced_declare), schedule(schedule),
+      offsets(forwards.size()+1), pending(forwards.size()), emitted(), opened()
+{
+    for(size_t i=0; i<forwards.size(); ++i)
+        for(NameId depname : scheme.dependencies(forwards[i]))
+            if(blocks(forwards[i],depname)){ ++pending[i]; ++offsets[local.value(depname)+1]; }
+    for(size_t i=0; i<forwards.size(); ++i)offsets[i+1] += offsets[i];
+
+    blocked.resize(offsets.back());
+    vector<size_t> filled(begin(offsets),end(offsets)-1);
+    for(size_t i=0; i<forwards.size(); ++i)
+        for(NameId depname : scheme.dependencies(forwards[i]))
+            if(blocks(forwards[i],depname))blocked[filled[local.value(depname)]++] = i;
+}
+
+//a dependency blocks a forward until it is declared before, the dependencies left out
+//of the generated forwards are declared elsewhere, as by another shard
+static bool blocksForward(const InternedScheme &scheme, const NameMarks &local, const NameMarks &forced_declare,
+    NameId keyname, NameId depname)
+{
+    if(keyname==depname || scheme.isApplied(depname))return false;
+    if(forced_declare.test(depname))return local.test(depname);
+    //a missing dependency is reported by the closure, which does not reach beyond it
+    const TypeInfo *depinfo = scheme.info(depname);
+    return depinfo && !depinfo->isExternal() && local.test(depname);
+}
+
+bool Codegen::ForwardGraph::blocks(NameId keyname, NameId depname) const
+    { return blocksForward(scheme,local,forced_declare,keyname,depname); }
+
+void Codegen::ForwardGraph::start()
+{
+    for(size_t i=0; i<forwards.size(); ++i)
+        if(pending[i]==0)schedule.markReady(schedule.index.nodeOf(forwards[i]),schedule.index.rankOf(forwards[i]));
+}
+
+template <class Target> void Codegen::ForwardGraph::emit(Target &code, NameId keyname)
+{
+    code.declareForward(keyname); ++emitted;
+    size_t i = local.value(keyname);
+    for(size_t edge=offsets[i]; edge<offsets[i+1]; ++edge)
+        if(size_t next = blocked[edge]; --pending[next]==0)
+            schedule.markReady(schedule.index.nodeOf(forwards[next]),schedule.index.rankOf(forwards[next]));
+}
+
+vector<LongName> Codegen::ForwardGraph::findLoop() const
+{
+    //every forward left has a pending dependency which is also left
+    vector<size_t> step(forwards.size(),forwards.size()), path;
+    size_t i = 0; while(i<forwards.size() && pending[i]==0)++i;
+    while(i<forwards.size() && step[i]==forwards.size())
+    {
+        step[i] = path.size(); path.push_back(i);
+        size_t next = forwards.size();
+        for(NameId depname : scheme.dependencies(forwards[i]))
+            if(blocks(forwards[i],depname) && pending[local.value(depname)]>0){ next = local.value(depname); break; }
+        i = next;
+    }
+
+    vector<LongName> loop;
+    if(i<forwards.size())for(size_t k=step[i]; k<path.size(); ++k)
+        loop.emplace_back(scheme.view(forwards[path[k]]));
+    return loop;
+}
+
+Codegen::NamespaceSchedule::NamespaceSchedule(const NamespaceIndex &index)
+    : index(index), states(storage().states), ready_nodes(storage().ready_nodes), touched(storage().touched)
+{
+    //the marks left by a failed generation are cleared first, the arrays never shrink
+    for(NodeId node : touched)ready_nodes[node/64] &= ~(uint64_t(1)<<node%64);
+    touched.clear();
+    if(states.size()<index.size())states.resize(index.size());
+    if(ready_nodes.size()<index.size()/64+1)ready_nodes.resize(index.size()/64+1);
+    epoch = ++storage().epoch;
+    if(epoch==0){ for(NodeState &state : states)state.epoch = 0; epoch = storage().epoch = 1; }
+}
+
+void Codegen::NamespaceSchedule::place(NodeId node)
+{
+    for(; node!=NamespaceIndex::NoNode && states[node].epoch!=epoch; node = index.node(node).parent)
+    {
+        NodeState &state = states[node];
+        state.epoch = epoch; state.ready_count = 0; state.iterations = 0; state.ready_forwards.clear();
+        touched.push_back(node);
+    }
+}
+
+void Codegen::NamespaceSchedule::markReady(NodeId node, uint32_t rank)
+{
+    vector<uint32_t> &ready = states[node].ready_forwards;
+    ready.push_back(rank); push_heap(begin(ready),end(ready),greater<uint32_t>());
+    for(; node!=NamespaceIndex::Root; node = index.node(node).parent)
+        if(states[node].ready_count++==0)ready_nodes[node/64] |= uint64_t(1)<<node%64;
+    ++states[NamespaceIndex::Root].ready_count;
+}
+
+Codegen::NamespaceSchedule::NodeId Codegen::NamespaceSchedule::nextReady(NodeId first, NodeId last) const
+{
+    //the children of a namespace are contiguous, so their marks are scanned by words
+    while(first<last)
+    {
+        uint64_t word = ready_nodes[first/64]>>first%64;
+        if(word)return min<NodeId>(first+static_cast<NodeId>(countTrailingZeros(word)),last);
+        first = (first/64+1)*64;
+    }
+    return last;
+}
+
+template <class Target> void Codegen::NamespaceSchedule::renderNode(Target &code, ForwardGraph &graph, NodeId node)
+{
+    NodeState &state = states[node];
+    const NamespaceIndex::Node &info = index.node(node);
+    NodeId last = info.first_child+info.child_count;
+    while(state.ready_count>0)
+    {
+        ++state.iterations;
+        //the forwards of this namespace made ready meanwhile are declared at once
+        while(!state.ready_forwards.empty())
+        {
+            vector<uint32_t> &ready = state.ready_forwards;
+            pop_heap(begin(ready),end(ready),greater<uint32_t>());
+            NameId keyname = index.types(node)[ready.back()]; ready.pop_back();
+            for(NodeId up = node; up!=NamespaceIndex::Root; up = index.node(up).parent)
+                if(--states[up].ready_count==0)ready_nodes[up/64] &= ~(uint64_t(1)<<up%64);
+            --states[NamespaceIndex::Root].ready_count;
+            graph.emit(code,keyname);
+        }
+
+        for(NodeId child = nextReady(info.first_child,last); child<last; child = nextReady(child+1,last))
+        {
+            code.openNamespace(index.node(child).space); ++graph.opened;
+            renderNode(code,graph,child);
+            code.closeNamespace();
+        }
+    }
+}
+
+void Codegen::NamespaceSchedule::report(CodegenStats &stats, const InternedScheme &scheme) const
+{
+    for(NodeId node : touched)
+    {
+        NameId space = index.node(node).space;
+        stats.addIterations(space==NoName ? string_view() : scheme.view(space),states[node].iterations);
+    }
 }
 
-void IntermediateCode::openNamespace(const string &name)
-    { m_code.push_back({Command::OpenNamespace,name}); }
+//orders modules as 'ModuleName' does: system modules first, then by name
+static bool moduleLess(string_view lhs, string_view rhs)
+{
+    bool lhs_system = lhs.front()=='<', rhs_system = rhs.front()=='<';
+    if(lhs_system!=rhs_system)return lhs_system;
+    return lhs.substr(1,lhs.size()-2)<rhs.substr(1,rhs.size()-2);
+}
 
-void IntermediateCode::declareForward(const string &name)
-    { m_code.push_back({Command::ForwardDeclaration,name}); }
+//the transitive reduction of the ordered modules by the include graph: a module is dropped
+//when another one includes it, of the modules including each other the former is kept
+static void reduceModules(const InternedScheme &scheme, vector<NameId> &modules)
+{
+    size_t count = modules.size();
+    static thread_local NameMarks members, reached;
+    members.reset(scheme.names()->size());
+    for(size_t i=0; i<count; ++i)members.set(modules[i],static_cast<NameId>(i));
 
-void IntermediateCode::closeNamespace()
-{ 
-    if(!m_code.empty() && m_code[m_code.size()-1].first==Command::OpenNamespace)
-        m_code.pop_back();
-    else m_code.push_back({Command::CloseNamespace,string()}); 
+    vector<bool> reaches(count*count);
+    vector<NameId> pending;
+    for(size_t i=0; i<count; ++i)
+    {
+        reached.reset(scheme.names()->size());
+        pending.assign(1,modules[i]);
+        while(!pending.empty())
+        {
+            NameId module = pending.back(); pending.pop_back();
+            for(NameId included : scheme.moduleIncludes(module))if(!reached.test(included))
+            {
+                reached.set(included); pending.push_back(included);
+                if(members.test(included))reaches[i*count+members.value(included)] = true;
+            }
+        }
+    }
+
+    size_t kept = 0;
+    for(size_t j=0; j<count; ++j)
+    {
+        bool covered = false;
+        for(size_t i=0; i<count && !covered; ++i)
+            covered = i!=j && reaches[i*count+j] && (i<j || !reaches[j*count+i]);
+        if(!covered)modules[kept++] = modules[j];
+    }
+    modules.resize(kept);
 }
 
-string IntermediateCode::translate(const map<LongName,shared_ptr<TypeInfo>> &scheme) const
+Codegen::Codegen(shared_ptr<SchemeArena> arena) : m_arena(move(arena))
 {
-    stringstream ss; bool force_endl = false;
-    auto skip = [&ss,&force_endl](size_t indent) -> stringstream&
-    { 
-        if(force_endl){ ss<<endl; force_endl=false; }
-        for(size_t i=0; i<indent; ++i)ss<<"\t"; return ss; 
-    };
+    //the keys kept by the arena are sorted in place of a map of their copies
+    vector<pair<string_view,TypeInfo*>> entries(m_arena->entries());
+    sort(begin(entries),end(entries),[](const auto &lhs, const auto &rhs) { return lhs.first<rhs.first; });
+    if(adjacent_find(begin(entries),end(entries),[](const auto &lhs, const auto &rhs) { return lhs.first==rhs.first; })
+        !=end(entries))
+    {
+        //the first key met again in the order of the arena is reported, as the map did
+        unordered_set<string_view> keys;
+        for(const auto & [keyname, info] : m_arena->entries())
+            if(!keys.insert(keyname).second)throw DuplicateKeyError(LongName(keyname));
+    }
+    m_interned = InternedScheme(entries,m_some_fundamental,m_arena);
+    checkTypes();
+}
 
-    vector<string> deepname; deepname.push_back(string());
-    for(size_t indent=0, i=0; i<m_code.size(); ++i)switch(m_code[i].first)
-    {
-    case Command::IncludeModule:
-        ss<<"#include "<<m_code[i].second<<endl; force_endl=true;
-        break;
-    case Command::OpenNamespace:
-        skip(indent)<<"namespace "<<m_code[i].second<<endl;
-        skip(indent)<<"{"<<endl; 
-        deepname.push_back(deepname[indent++]+m_code[i].second+"::"); 
-        break;
-    case Command::ForwardDeclaration:
-        {
-            auto forward_it = scheme.find(deepname[indent]+m_code[i].second);
-            if(forward_it==scheme.end())throw NotFoundKeyError(deepname[indent]+m_code[i].second);
-            const auto & [keyname, info] = *forward_it;
-            info->translate(skip(indent),deepname[indent],m_code[i].second);
-        } break;
-    case Command::CloseNamespace:
-        deepname.pop_back(); if(deepname.empty())throw NamespaceNestingError();
-        skip(--indent)<<"}"<<endl; 
-        break;
-    default:
-        throw bad_exception();
+Codegen::Codegen(shared_ptr<const Snapshot> snapshot)
+    : m_snapshot(snapshot), m_interned(move(snapshot))
+{
+    //the checks ran when the snapshot was written, their messages are kept by it
+    for(auto & [keyname, message] : m_snapshot->rejected())
+        m_rejected.emplace(keyname,Rejection{make_exception_ptr(runtime_error(message)),message});
+}
+
+const map<LongName,shared_ptr<TypeInfo>>& Codegen::getSheme() const
+{
+    //the ordered view is built by the first request, the types of the arena or the snapshot
+    //are shared with it and the others with their owners
+    lock_guard lock(m_memo.mutex);
+    if(!m_scheme_built)
+    {
+        shared_ptr<const void> owner = m_snapshot;
+        if(!owner)owner = m_arena;
+        for(NameId id = 0; id<m_interned.size(); ++id)
+            if(const TypeInfo *info = m_interned.info(id))
+            {
+                shared_ptr<TypeInfo> shared = id<m_owners.size() ? m_owners[id] : nullptr;
+                if(!shared)shared = shared_ptr<TypeInfo>(owner,const_cast<TypeInfo*>(info));
+                m_scheme.emplace(LongName(m_interned.view(id)),move(shared));
+            }
+        m_scheme_built = true;
     }
-    return ss.str();
+    return m_scheme;
 }
 
-bool IntermediateCode::verify(
-    const map<LongName,shared_ptr<TypeInfo>> &scheme,
-    const vector<LongName> &include_names, const vector<LongName> &declare_names,
-    const set<LongName> &applied) const
-{
-    set<LongName> completed(applied.begin(),applied.end());
-    set<LongName> forced_declare(begin(declare_names),end(declare_names));
-    set<ModuleName> modules;
-
-    vector<string> deepname; deepname.push_back(string());
-    for(size_t indent=0, i=0; i<m_code.size(); ++i)switch(m_code[i].first)
-    {
-    case Command::IncludeModule:
-        modules.insert(m_code[i].second);
-        break;
-    case Command::OpenNamespace:
-        deepname.push_back(deepname[indent++]+m_code[i].second+"::");
-        break;
-    case Command::ForwardDeclaration:
+shared_ptr<const NamespaceIndex> Codegen::namespaces() const
+{
+    //the index is built by the first generation and kept until a new name is added
+    lock_guard lock(m_memo.mutex);
+    if(!m_memo.namespaces)m_memo.namespaces = make_shared<const NamespaceIndex>(m_interned);
+    return m_memo.namespaces;
+}
+
+void Codegen::load(const map<LongName,shared_ptr<TypeInfo>> &scheme)
+{
+    //the names are kept by the name table only, the types by the identifiers of their keys
+    m_interned = InternedScheme(scheme,m_some_fundamental);
+    m_owners.resize(m_interned.size());
+    for(const auto & [keyname, info] : scheme)m_owners[m_interned.find(keyname)] = info;
+    checkTypes();
+}
+
+void Codegen::checkTypes()
+{
+    //the types are checked once, a rejected type fails the generation which reaches it
+    SchemeLookup lookup(*this);
+    for(NameId id = 0; id<m_interned.size(); ++id)
+        if(const TypeInfo *info = m_interned.info(id))
+            try { info->check(m_interned.view(id),lookup); }
+            catch(const exception &ex) { m_rejected.emplace(id,Rejection{current_exception(),ex.what()}); }
+            catch(...) { m_rejected.emplace(id,Rejection{current_exception(),"unknown error"}); }
+}
+
+Codegen Codegen::resolveScheme(const vector<LongName> &names) const
+{
+    Codegen resolved(m_resolver->closure(names,m_some_fundamental,getSheme()));
+    resolved.m_verification = m_verification;
+    if(!m_module_graph.empty())resolved.setModuleGraph(m_module_graph);
+    return resolved;
+}
+
+Codegen Codegen::resolveScheme(const vector<CodeRequest> &requests) const
+{
+    //the requests of a batch share one scheme of the union of their names
+    vector<LongName> names;
+    for(const CodeRequest &request : requests)
+    {
+        names.insert(names.end(),request.include_names.begin(),request.include_names.end());
+        names.insert(names.end(),request.declare_names.begin(),request.declare_names.end());
+    }
+    return resolveScheme(names);
+}
+
+static vector<LongName> requestNames(const vector<LongName> &include_names, const vector<LongName> &declare_names)
+{
+    vector<LongName> names(include_names);
+    names.insert(names.end(),declare_names.begin(),declare_names.end());
+    return names;
+}
+
+struct Codegen::Closure
+{
+    vector<NameId> forwards;
+    vector<NameId> modules;
+    //the fingerprint of the types of the closure made by the first 'fingerprint' of it
+    mutable shared_ptr<const string> digest;
+};
+
+vector<NameId> Codegen::resolveDeclared(const vector<LongName> &declare_names, Diagnostics *diagnostics) const
+{
+    vector<NameId> roots;
+    for(const LongName &name : declare_names)
+        if(NameId id = m_interned.find(name); !m_interned.info(id))
+            Diagnostics::report(diagnostics,DiagnosticKind::NotFoundKey,name,NotFoundKeyError(name));
+        else roots.push_back(id);
+    return roots;
+}
+
+exception_ptr Codegen::closureError(const vector<LongName> &declare_names) const
+{
+    //the closures are walked together breadth first, as the generation did before they were memoized
+    const InternedScheme &scheme = m_interned;
+    vector<bool> placed(scheme.size());
+    queue<pair<NameId,string_view>> depends;
+    for(const LongName &name : declare_names)depends.emplace(scheme.find(name),name);
+    for(; !depends.empty(); depends.pop())
+    {
+        auto [keyname, name] = depends.front();
+        if(!scheme.info(keyname))return make_exception_ptr(NotFoundKeyError(LongName(name)));
+        if(placed[keyname])continue;
+        placed[keyname] = true;
+        if(auto rejected_it = m_rejected.find(keyname); rejected_it!=m_rejected.end())return rejected_it->second.error;
+        for(NameId depname : scheme.dependencies(keyname))
+            if(!scheme.isApplied(depname))
+            {
+                const TypeInfo *depinfo = scheme.info(depname);
+                if(!depinfo)return make_exception_ptr(NotFoundKeyError(LongName(scheme.view(depname))));
+                if(!depinfo->isExternal())depends.emplace(depname,scheme.view(depname));
+            }
+    }
+    return nullptr;
+}
+
+Codegen::Closure Codegen::collectClosure(const vector<NameId> &roots, Diagnostics *diagnostics) const
+{
+    const InternedScheme &scheme = m_interned;
+    Closure closure;
+    static thread_local NameMarks placed, included;
+    placed.reset(scheme.size()); included.reset(scheme.size());
+
+    queue<NameId> depends;
+    for(NameId id : roots)depends.push(id);
+    while(!depends.empty())
+    {
+        NameId keyname = depends.front();
+        if(!placed.test(keyname))
         {
-            LongName keyname = deepname[indent]+m_code[i].second;
-            auto forward_it = scheme.find(keyname);
-            if(forward_it==scheme.end())throw NotFoundKeyError(keyname);
-            shared_ptr<TypeInfo> info = forward_it->second;
-
-            //check for double forward
-            if(!completed.insert(keyname).second)throw DuplicateForwardError(keyname);
-
-            //check for module include
-            if(info->isExternal() && modules.find(info->getModule())==modules.end())
-                throw NotFoundModuleError(info->getModule().view());
-
-            //check dependencies for forward and/or include
-            for(const LongName &depname : info->dependencies())
-                if(completed.find(depname)==completed.end())
-                    if(forced_declare.find(depname)!=forced_declare.end())throw NotFoundForwardError(depname);
-                    else
+            placed.set(keyname); closure.forwards.push_back(keyname);
+            if(NameId mname = scheme.module(keyname); mname!=NoName && !included.test(mname))
+                { included.set(mname); closure.modules.push_back(mname); }
+            if(!m_rejected.empty())
+                if(auto rejected_it = m_rejected.find(keyname); rejected_it!=m_rejected.end())
+                    Diagnostics::report(diagnostics,DiagnosticKind::RejectedType,scheme.view(keyname),
+                        rejected_it->second.error,rejected_it->second.message);
+            for(NameId depname : scheme.dependencies(keyname))
+                if(!scheme.isApplied(depname))
+                {
+                    const TypeInfo *depinfo = scheme.info(depname);
+                    if(!depinfo)
                     {
-                        auto depend_it = scheme.find(depname);
-                        if(depend_it==scheme.end())throw NotFoundKeyError(depname);
-                        shared_ptr<TypeInfo> depinfo = depend_it->second;
-                    
-                        if(depinfo->isExternal())
-                        {
-                            if(modules.find(depinfo->getModule())==modules.end())
-                                throw NotFoundModuleError(depinfo->getModule().view());
-                        }
-                        else throw NotFoundForwardError(depname);
+                        string depview(scheme.view(depname));
+                        Diagnostics::report(diagnostics,DiagnosticKind::NotFoundKey,depview,NotFoundKeyError(depview));
+                        continue;
                     }
-        } break;
-    case Command::CloseNamespace:
-        deepname.pop_back(); if(deepname.empty())throw NamespaceNestingError();
-        --indent;
-        break;
-    default:
-        throw bad_exception();
-    }
-
-    //check namespace hierarchy
-    deepname.pop_back(); if(!deepname.empty())throw NamespaceNestingError();
-
-    //check for include forced names
-    for(const LongName &keyname : include_names)
-        if(auto forward_it = scheme.find(keyname); forward_it==scheme.end())
-            throw NotFoundKeyError(keyname);
-        else
+                    if(!depinfo->isExternal())depends.push(depname);
+                    else if(NameId mname = scheme.module(depname); !included.test(mname))
+                        { included.set(mname); closure.modules.push_back(mname); }
+                }
+        }
+        depends.pop();
+    }
+    return closure;
+}
+
+template <class Target> void Codegen::renderCode(Target &target, const vector<const Closure*> &closures,
+	const vector<LongName> &include_names,
+	const vector<LongName> &declare_names,
+    CodegenStats *stats, Diagnostics *diagnostics) const
+{ 
+    const InternedScheme &scheme = m_interned;
+    vector<NameId> forwards, modules;
+    static thread_local NameMarks local, included, forced_declare;
+    local.reset(scheme.size()); included.reset(scheme.size()); forced_declare.reset(scheme.size());
+    auto includeModule = [&modules](NameId mname)
+        { if(mname!=NoName && !included.test(mname)){ included.set(mname); modules.push_back(mname); } };
+
+    //mark the namespaces of the forwards in the index of the scheme
+    shared_ptr<const NamespaceIndex> index = namespaces();
+    NamespaceSchedule schedule(*index);
+    {
+        CodegenStats::Scope scope(stats,CodegenStats::Phase::Namespaces);
+        for(const Closure *closure : closures)
         {
-            shared_ptr<TypeInfo> info = forward_it->second;
-            if(modules.find(info->getModule())==modules.end()) 
-                    throw NotFoundModuleError(info->getModule().view());
+            for(NameId keyname : closure->forwards)if(!local.test(keyname))
+            {
+                NamespaceIndex::NodeId node = index->nodeOf(keyname);
+                if(node==NamespaceIndex::NoNode)
+                {
+                    //a key with no place in the namespaces is left out of the rendering
+                    Diagnostics::report(diagnostics,DiagnosticKind::MalformedKey,scheme.view(keyname),SyntaxError());
+                    continue;
+                }
+                schedule.place(node);
+                local.set(keyname,static_cast<NameId>(forwards.size())); forwards.push_back(keyname);
+            }
+            for(NameId mname : closure->modules)includeModule(mname);
         }
+    }
 
-    //check for forward forced names
-    for(const LongName &keyname : declare_names)
-        if(completed.find(keyname)==completed.end())throw NotFoundForwardError(keyname);
+    //render modules list
+    {
+        CodegenStats::Scope scope(stats,CodegenStats::Phase::Modules);
+        for(const LongName &keyname : include_names)
+            if(NameId id = scheme.find(keyname); !scheme.info(id))
+                Diagnostics::report(diagnostics,DiagnosticKind::NotFoundKey,keyname,NotFoundKeyError(keyname));
+            else includeModule(scheme.module(id));
+        sort(begin(modules),end(modules),[&scheme](NameId lhs, NameId rhs)
+            { return moduleLess(scheme.view(lhs),scheme.view(rhs)); });
+        if(scheme.hasModuleGraph())reduceModules(scheme,modules);
+        for(NameId mname : modules)target.includeModule(mname);
+    }
+
+    //render namespaces and forwards
+    {
+        CodegenStats::Scope scope(stats,CodegenStats::Phase::Rendering);
+        //a missing declared name is reported by the closures
+        for(const LongName &keyname : declare_names)
+            if(NameId id = scheme.find(keyname); id!=NoName)forced_declare.set(id);
+        ForwardGraph graph(scheme,forwards,local,forced_declare,schedule);
+        graph.start();
+        schedule.renderNode(target,graph,NamespaceIndex::Root);
+        if(graph.emitted<forwards.size())
+        {
+            vector<LongName> loop = graph.findLoop();
+            Diagnostics::report(diagnostics,DiagnosticKind::LoopForward,loop.empty() ? string() : loop.front(),
+                LoopForwardError(loop));
+        }
+
+        //the scheduler opens a namespace only for a ready forward, so every one is closed
+        if(stats)
+        {
+            stats->counters().namespaces_opened += graph.opened;
+            stats->counters().namespaces_closed += graph.opened;
+        }
+    }
+
+    if(stats)
+    {
+        CodegenStats::Counters &counters = stats->counters();
+        counters.lookups += include_names.size()+declare_names.size();
+        counters.closure_forwards += forwards.size();
+        counters.closure_modules += modules.size();
+        stats->notePeakCodeSize(target.size());
+        schedule.report(*stats,scheme);
+    }
+}
+
+shared_ptr<const Codegen::Closure> Codegen::rootClosure(NameId root, CodegenStats *stats,
+    Diagnostics *diagnostics) const
+{
+    CodegenStats::Scope scope(stats,CodegenStats::Phase::Closure);
+    {
+        lock_guard lock(m_memo.mutex);
+        if(auto memo_it = m_memo.closures.find(root); memo_it!=m_memo.closures.end())
+        {
+            if(stats)++stats->counters().memo_hits;
+            return memo_it->second;
+        }
+    }
+    Diagnostics found;
+    auto closure = make_shared<const Closure>(collectClosure({root},diagnostics ? &found : nullptr));
+    if(!found.empty()){ diagnostics->append(found); return closure; }
+    lock_guard lock(m_memo.mutex);
+    return m_memo.closures.try_emplace(root,move(closure)).first->second;
+}
+
+vector<shared_ptr<const Codegen::Closure>> Codegen::requestClosures(
+    const vector<LongName> &declare_names, CodegenStats *stats, Diagnostics *diagnostics) const
+{
+    vector<shared_ptr<const Closure>> closures;
+    if(stats)stats->counters().lookups += declare_names.size();
+    try
+    {
+        //a declared name is looked up just before its closure, so its problems come in its turn
+        for(const LongName &name : declare_names)
+            if(NameId id = m_interned.find(name); !m_interned.info(id))
+                Diagnostics::report(diagnostics,DiagnosticKind::NotFoundKey,name,NotFoundKeyError(name));
+            else closures.push_back(rootClosure(id,stats,diagnostics));
+    }
+    catch(...)
+    {
+        if(exception_ptr error = closureError(declare_names))rethrow_exception(error);
+        throw;
+    }
+    return closures;
+}
+
+template <class Target> void Codegen::generate(Target &target, const vector<const Closure*> &closures,
+	const vector<LongName> &include_names,
+	const vector<LongName> &declare_names,
+    CodegenStats *stats, Diagnostics *diagnostics) const
+{
+    if(!m_verification)return renderCode(target,closures,include_names,declare_names,stats,diagnostics);
+    VerifiedTarget<Target> verified(target,m_interned,*m_interned.names(),declare_names,diagnostics);
+    renderCode(verified,closures,include_names,declare_names,stats,diagnostics);
+    verified.finish(include_names,declare_names);
+}
+
+IntermediateCode Codegen::generateCode(const vector<LongName> &include_names, const vector<LongName> &declare_names,
+    CodegenStats *stats, Diagnostics *diagnostics) const
+{
+    vector<shared_ptr<const Closure>> closures = requestClosures(declare_names,stats,diagnostics);
+    vector<const Closure*> parts;
+    for(const auto &closure : closures)parts.push_back(closure.get());
+    IntermediateCode icode(m_interned.names());
+    generate(icode,parts,include_names,declare_names,stats,diagnostics);
+    return icode;
+}
+
+IntermediateCode Codegen::code(
+	const vector<LongName> &include_names,
+	const vector<LongName> &declare_names,
+    CodegenStats *stats) const
+{ 
+    if(m_resolver)return resolveScheme(requestNames(include_names,declare_names)).code(include_names,declare_names,stats);
+    CodeResult result = tryCode(include_names,declare_names,stats);
+    raiseFirst(result.diagnostics,declare_names);
+    return move(result.code);
+}
+
+CodeResult Codegen::tryCode(
+	const vector<LongName> &include_names,
+	const vector<LongName> &declare_names,
+    CodegenStats *stats) const
+{
+    if(m_resolver)return resolveScheme(requestNames(include_names,declare_names)).tryCode(include_names,declare_names,stats);
+    CodeResult result;
+    result.code = generateCode(include_names,declare_names,stats,&result.diagnostics);
+    return result;
+}
+
+bool Codegen::verifyRequest(const vector<LongName> &include_names, const vector<LongName> &declare_names,
+    CodegenStats *stats, Diagnostics *diagnostics) const
+{
+    //the commands are checked as they are rendered, neither the code nor the text is kept
+    vector<shared_ptr<const Closure>> closures = requestClosures(declare_names,stats,diagnostics);
+    vector<const Closure*> parts;
+    for(const auto &closure : closures)parts.push_back(closure.get());
+    CodeVerifier verifier(m_interned,*m_interned.names(),declare_names,diagnostics);
+    renderCode(verifier,parts,include_names,declare_names,stats,diagnostics);
+    CodegenStats::Scope scope(stats,CodegenStats::Phase::Verification);
+    if(stats)stats->counters().lookups += 2*declare_names.size()+2*include_names.size();
+    verifier.finish(include_names,declare_names);
+    return !diagnostics || diagnostics->empty();
+}
 
+bool Codegen::test(
+	const vector<LongName> &include_names,
+	const vector<LongName> &declare_names,
+    CodegenStats *stats) const
+{
+    if(m_resolver)return resolveScheme(requestNames(include_names,declare_names)).test(include_names,declare_names,stats);
+    raiseFirst(diagnose(include_names,declare_names,stats),declare_names);
     return true;
 }
 
+Diagnostics Codegen::diagnose(
+	const vector<LongName> &include_names,
+	const vector<LongName> &declare_names,
+    CodegenStats *stats) const
+{
+    if(m_resolver)return resolveScheme(requestNames(include_names,declare_names)).diagnose(include_names,declare_names,stats);
+    Diagnostics diagnostics;
+    verifyRequest(include_names,declare_names,stats,&diagnostics);
+    return diagnostics;
+}
+
+void Codegen::raiseFirst(const Diagnostics &diagnostics, const vector<LongName> &declare_names) const
+{
+    //a problem of the closures is raised in the order of the whole closure, as one request meets it
+    if(diagnostics.empty())return;
+    if(exception_ptr error = closureError(declare_names))rethrow_exception(error);
+    diagnostics.raise();
+}
+
+Diagnostics Codegen::diagnoseScheme() const
+{
+    //the types are checked when they are loaded or changed, the rejections are kept by their identifiers
+    vector<pair<string_view,const Rejection*>> rejected;
+    for(const auto & [keyname, rejection] : m_rejected)rejected.emplace_back(m_interned.view(keyname),&rejection);
+    sort(begin(rejected),end(rejected));
+    Diagnostics diagnostics;
+    for(const auto & [keyname, rejection] : rejected)
+        diagnostics.add(DiagnosticKind::RejectedType,keyname,rejection->message,rejection->error);
+    return diagnostics;
+}
 
+void Codegen::save(OutputSink &sink) const
+{
+    map<NameId,string> messages;
+    for(const auto & [keyname, rejection] : m_rejected)messages.emplace(keyname,rejection.message);
+    Snapshot::write(sink,m_interned,messages);
+}
 
-struct Codegen::NamespaceModelNode
+string Codegen::renderText(const vector<const Closure*> &closures,
+    const vector<LongName> &include_names, const vector<LongName> &declare_names, CodegenStats *stats) const
 {
-    set<string> forwards;
-    map<string,NamespaceModelNode> attachments;
-    size_t incompleted_count;
-    NamespaceModelNode() : incompleted_count() {}
+    return writeText([&](TextWriter &writer) { generate(writer,closures,include_names,declare_names,stats); },
+        *m_interned.names(),m_interned);
+}
 
-    bool placeForward(string_view id);
-    void renderNode(IntermediateCode &code, 
-        set<LongName> &completed, const set<LongName> &forced_declare,
-        const map<LongName,shared_ptr<TypeInfo>> &scheme, const string &key = string());
-};
+string Codegen::source(
+	const vector<LongName> &include_names,
+	const vector<LongName> &declare_names,
+    CodegenStats *stats) const
+{
+    if(m_resolver)return resolveScheme(requestNames(include_names,declare_names)).source(include_names,declare_names,stats);
+    vector<shared_ptr<const Closure>> closures = requestClosures(declare_names,stats);
+    vector<const Closure*> parts;
+    for(const auto &closure : closures)parts.push_back(closure.get());
+    return renderText(parts,include_names,declare_names,stats);
+}
+
+void Codegen::source(OutputSink &sink,
+	const vector<LongName> &include_names,
+	const vector<LongName> &declare_names,
+    CodegenStats *stats) const
+{
+    //the rendering writes the text at once, no intermediate code is kept
+    if(m_resolver)
+        return resolveScheme(requestNames(include_names,declare_names)).source(sink,include_names,declare_names,stats);
+    vector<shared_ptr<const Closure>> closures = requestClosures(declare_names,stats);
+    vector<const Closure*> parts;
+    for(const auto &closure : closures)parts.push_back(closure.get());
+    SourceWriter writer(sink,*m_interned.names(),m_interned);
+    generate(writer,parts,include_names,declare_names,stats);
+    sink.flush();
+}
+
+shared_ptr<ThreadPool> Codegen::batchPool(unsigned threads) const
+{
+    lock_guard lock(m_batch_pool.mutex);
+    if(!m_batch_pool.pool || m_batch_pool.threads!=threads)
+    {
+        m_batch_pool.pool = make_shared<ThreadPool>(threads);
+        m_batch_pool.threads = threads;
+    }
+    return m_batch_pool.pool;
+}
+
+template <class Render> void Codegen::renderBatch(const vector<CodeRequest> &requests, ThreadPool &pool,
+    Render render) const
+{
+    //the closure of each declared name is collected once for all requests
+    vector<vector<size_t>> request_roots(requests.size());
+    vector<exception_ptr> errors(requests.size());
+    unordered_map<NameId,size_t> root_index; vector<NameId> roots;
+    for(size_t i=0; i<requests.size(); ++i)
+        try
+        {
+            for(NameId id : resolveDeclared(requests[i].declare_names))
+            {
+                auto [index_it, added] = root_index.try_emplace(id,roots.size());
+                if(added)roots.push_back(id);
+                request_roots[i].push_back(index_it->second);
+            }
+        }
+        catch(...)
+        {
+            errors[i] = closureError(requests[i].declare_names);
+            if(!errors[i])errors[i] = current_exception();
+        }
+
+    vector<shared_ptr<const Closure>> closures(roots.size());
+    vector<exception_ptr> closure_errors(roots.size());
+    pool.parallelFor(roots.size(),[&](size_t i)
+    {
+        try { closures[i] = rootClosure(roots[i]); }
+        catch(...) { closure_errors[i] = current_exception(); }
+    });
+
+    pool.parallelFor(requests.size(),[&](size_t i)
+    {
+        if(errors[i])return;
+        try
+        {
+            vector<const Closure*> parts;
+            for(size_t root : request_roots[i])
+                if(closure_errors[root])
+                {
+                    //the first problem of the request is the one its own walk meets first
+                    exception_ptr error = closureError(requests[i].declare_names);
+                    rethrow_exception(error ? error : closure_errors[root]);
+                }
+                else parts.push_back(closures[root].get());
+            render(i,parts);
+        }
+        catch(...) { errors[i] = current_exception(); }
+    });
+
+    for(const exception_ptr &error : errors)if(error)rethrow_exception(error);
+}
+
+vector<IntermediateCode> Codegen::codeBatch(const vector<CodeRequest> &requests, ThreadPool &pool) const
+{
+    if(m_resolver)return resolveScheme(requests).codeBatch(requests,pool);
+    vector<IntermediateCode> results(requests.size(),IntermediateCode(m_interned.names()));
+    renderBatch(requests,pool,[&](size_t i, const vector<const Closure*> &parts)
+        { generate(results[i],parts,requests[i].include_names,requests[i].declare_names); });
+    return results;
+}
 
-bool Codegen::NamespaceModelNode::placeForward(string_view id)
+vector<string> Codegen::sourceBatch(const vector<CodeRequest> &requests, ThreadPool &pool) const
 {
-    if(id.empty())throw SyntaxError();
-    string_view::const_iterator vbeg {begin(id)};
-    string_view::const_iterator vend {end(id)};
-    while(vbeg!=vend)if(*vbeg==':')
+    if(m_resolver)return resolveScheme(requests).sourceBatch(requests,pool);
+    vector<string> results(requests.size());
+    renderBatch(requests,pool,[&](size_t i, const vector<const Closure*> &parts)
+        { results[i] = renderText(parts,requests[i].include_names,requests[i].declare_names); });
+    return results;
+}
+
+vector<Shard> Codegen::sourceShards(const vector<LongName> &include_names,
+    const vector<LongName> &declare_names, const ShardOptions &options, ThreadPool &pool) const
+{
+    if(m_resolver)
+        return resolveScheme(requestNames(include_names,declare_names)).sourceShards(include_names,declare_names,options,pool);
+    const InternedScheme &scheme = m_interned;
+    vector<shared_ptr<const Closure>> closures = requestClosures(declare_names,nullptr);
+    shared_ptr<const NamespaceIndex> index = namespaces();
+
+    //every forward of the request is declared by one shard
+    vector<NameId> forwards;
+    static thread_local NameMarks local, forced_declare;
+    local.reset(scheme.size()); forced_declare.reset(scheme.size());
+    for(const auto &closure : closures)
+        for(NameId keyname : closure->forwards)
+            if(!local.test(keyname)){ local.set(keyname,static_cast<NameId>(forwards.size())); forwards.push_back(keyname); }
+    for(const LongName &keyname : declare_names)forced_declare.set(scheme.find(keyname));
+
+    //the forwards of one namespace make a unit, the units depend on each other by the forwards
+    vector<uint32_t> unit_of(forwards.size());
+    unordered_map<NamespaceIndex::NodeId,uint32_t> units;
+    vector<uint32_t> unit_order;
+    for(size_t i=0; i<forwards.size(); ++i)
+    {
+        NamespaceIndex::NodeId node = index->nodeOf(forwards[i]);
+        if(node==NamespaceIndex::NoNode)throw SyntaxError();
+        auto [unit_it, added] = units.try_emplace(node,static_cast<uint32_t>(unit_order.size()));
+        if(added)unit_order.push_back(index->preorder(node));
+        unit_of[i] = unit_it->second;
+    }
+    vector<vector<uint32_t>> unit_deps(unit_order.size());
+    for(size_t i=0; i<forwards.size(); ++i)
+        for(NameId depname : scheme.dependencies(forwards[i]))
+            if(blocksForward(scheme,local,forced_declare,forwards[i],depname))
+                if(uint32_t dep = unit_of[local.value(depname)]; dep!=unit_of[i])unit_deps[unit_of[i]].push_back(dep);
+    for(vector<uint32_t> &deps : unit_deps)
+        { sort(begin(deps),end(deps)); deps.erase(unique(begin(deps),end(deps)),end(deps)); }
+
+    //the units of a dependency loop are kept together
+    const uint32_t none = ~uint32_t(0);
+    vector<uint32_t> component(unit_order.size(),none), low(unit_order.size()), visit(unit_order.size(),none);
+    vector<uint32_t> stack, path;
+    vector<size_t> next_dep(unit_order.size());
+    uint32_t visited = 0, components = 0;
+    for(uint32_t start = 0; start<unit_order.size(); ++start)if(visit[start]==none)
     {
-        string space {begin(id),vbeg};
-        ++vbeg; if(vbeg==vend || *vbeg!=':')throw SyntaxError();
-        ++vbeg;
-        NamespaceModelNode &child = attachments.try_emplace(space,NamespaceModelNode()).first->second;
-        if(child.placeForward({id.data()+(vbeg-begin(id)),size_t(vend-vbeg)}))
-            { ++incompleted_count; return true; }
-        else return false;
-    } else ++vbeg;
-    if(forwards.insert(static_cast<string>(id)).second){ ++incompleted_count; return true; }
-    else return false;
+        path.push_back(start); visit[start] = low[start] = visited++; stack.push_back(start);
+        while(!path.empty())
+        {
+            uint32_t unit = path.back();
+            if(next_dep[unit]<unit_deps[unit].size())
+            {
+                uint32_t dep = unit_deps[unit][next_dep[unit]++];
+                if(visit[dep]==none)
+                    { visit[dep] = low[dep] = visited++; stack.push_back(dep); path.push_back(dep); }
+                else if(component[dep]==none)low[unit] = min(low[unit],visit[dep]);
+                continue;
+            }
+            path.pop_back();
+            if(!path.empty())low[path.back()] = min(low[path.back()],low[unit]);
+            if(low[unit]==visit[unit])
+            {
+                uint32_t member;
+                do { member = stack.back(); stack.pop_back(); component[member] = components; } while(member!=unit);
+                ++components;
+            }
+        }
+    }
+
+    //the components are ordered with their dependencies first, then by the namespace tree,
+    //and are packed into the shards by the budget, so a shard includes only the former ones
+    vector<uint32_t> component_order(components,none), component_size(components), pending(components);
+    vector<vector<uint32_t>> component_users(components);
+    for(uint32_t unit = 0; unit<unit_order.size(); ++unit)
+    {
+        component_order[component[unit]] = min(component_order[component[unit]],unit_order[unit]);
+        for(uint32_t dep : unit_deps[unit])if(component[dep]!=component[unit])
+            { component_users[component[dep]].push_back(component[unit]); ++pending[component[unit]]; }
+    }
+    for(size_t i=0; i<forwards.size(); ++i)++component_size[component[unit_of[i]]];
+
+    size_t count = max<size_t>(options.count,1);
+    size_t budget = options.budget ? options.budget : max<size_t>((forwards.size()+count-1)/count,1);
+    vector<uint32_t> shard_of(components);
+    size_t shards_count = 1, filled = 0;
+    priority_queue<pair<uint32_t,uint32_t>,vector<pair<uint32_t,uint32_t>>,greater<pair<uint32_t,uint32_t>>> ready;
+    for(uint32_t c = 0; c<components; ++c)if(pending[c]==0)ready.push({component_order[c],c});
+    while(!ready.empty())
+    {
+        uint32_t c = ready.top().second; ready.pop();
+        if(filled>0 && filled+component_size[c]>budget){ ++shards_count; filled = 0; }
+        shard_of[c] = static_cast<uint32_t>(shards_count-1); filled += component_size[c];
+        for(uint32_t user : component_users[c])if(--pending[user]==0)ready.push({component_order[user],user});
+    }
+
+    //the forwards, the modules, the included shards and the names they provide for every shard
+    vector<Shard> shards(shards_count);
+    vector<Closure> parts(shards_count);
+    vector<vector<uint32_t>> shard_includes(shards_count);
+    vector<vector<NameId>> provided(shards_count);
+    vector<vector<LongName>> declared(shards_count);
+    for(size_t i=0; i<shards_count; ++i)shards[i].name = options.prefix+"_"+to_string(i)+".h";
+    for(size_t i=0; i<forwards.size(); ++i)
+    {
+        NameId keyname = forwards[i];
+        uint32_t shard = shard_of[component[unit_of[i]]];
+        parts[shard].forwards.push_back(keyname);
+        shards[shard].forwards.emplace_back(scheme.view(keyname));
+        if(NameId mname = scheme.module(keyname); mname!=NoName)parts[shard].modules.push_back(mname);
+        for(NameId depname : scheme.dependencies(keyname))
+        {
+            if(scheme.isApplied(depname))continue;
+            if(const TypeInfo *depinfo = scheme.info(depname); depinfo && depinfo->isExternal())
+                parts[shard].modules.push_back(scheme.module(depname));
+            if(blocksForward(scheme,local,forced_declare,keyname,depname))
+                if(uint32_t other = shard_of[component[unit_of[local.value(depname)]]]; other!=shard)
+                    { shard_includes[shard].push_back(other); provided[shard].push_back(depname); }
+        }
+    }
+    for(const LongName &keyname : declare_names)
+        declared[shard_of[component[unit_of[local.value(scheme.find(keyname))]]]].push_back(keyname);
+    for(size_t i=0; i<shards_count; ++i)
+    {
+        vector<NameId> &modules = parts[i].modules;
+        sort(begin(modules),end(modules)); modules.erase(unique(begin(modules),end(modules)),end(modules));
+        vector<uint32_t> &includes = shard_includes[i];
+        sort(begin(includes),end(includes)); includes.erase(unique(begin(includes),end(includes)),end(includes));
+        for(uint32_t other : includes)shards[i].includes.push_back(shards[other].name);
+    }
+
+    //the forced includes go to the first shard
+    const vector<LongName> no_names;
+    pool.parallelFor(shards_count,[&](size_t i)
+    {
+        BufferSink sink;
+        ShardWriter writer(sink,*scheme.names(),scheme,shards[i].includes);
+        vector<const Closure*> part{&parts[i]};
+        const vector<LongName> &forced_includes = i==0 ? include_names : no_names;
+        if(!m_verification)renderCode(writer,part,forced_includes,declare_names);
+        else
+        {
+            VerifiedTarget<ShardWriter> verified(writer,scheme,*scheme.names(),declared[i]);
+            for(NameId depname : provided[i])verified.assume(depname);
+            renderCode(verified,part,forced_includes,declare_names);
+            verified.finish(forced_includes,declared[i]);
+        }
+        writer.finish();
+        shards[i].text = sink.release();
+    });
+    return shards;
 }
 
-void Codegen::NamespaceModelNode::renderNode(IntermediateCode &code,
-    set<LongName> &completed, const set<LongName> &forced_declare,
-    const map<LongName,shared_ptr<TypeInfo>> &scheme, const string &key)
+string Codegen::fingerprint(const vector<LongName> &include_names, const vector<LongName> &declare_names) const
 {
-    size_t incompleted_prev; do //loop the greedy algorithm
+    //the names are hashed instead of their identifiers, which differ between the schemes
+    if(m_resolver)return resolveScheme(requestNames(include_names,declare_names)).fingerprint(include_names,declare_names);
+    const InternedScheme &scheme = m_interned;
+    Fingerprint print;
+    vector<NameId> modules;
+    print.add(include_names.size());
+    for(const LongName &name : include_names)
     {
-        incompleted_prev = incompleted_count;
+        NameId id = scheme.find(name);
+        const TypeInfo *info = scheme.info(id);
+        print.add(name).add(info ? info->getModule().view() : string());
+        if(info)modules.push_back(scheme.module(id));
+    }
+    print.add(declare_names.size());
+    for(const LongName &name : declare_names)print.add(name);
 
-        for(const string& name : forwards)
-        if(LongName keyname = key+name; completed.find(keyname)==completed.end())
+    //a forward by the text it is declared with, its module and the kind of every dependency;
+    //the closure is dropped from the memo by a change it reaches, so its digest is kept with it
+    auto digest = [&scheme](const Closure &closure)
+    {
+        static thread_local string text;
+        Fingerprint print;
+        print.add(closure.forwards.size());
+        for(NameId keyname : closure.forwards)
         {
-            auto forward_it = scheme.find(keyname);
-            if(forward_it==scheme.end())throw NotFoundKeyError(keyname);
-            shared_ptr<TypeInfo> info = forward_it->second;
-               
-            auto check_dependencies = [&completed,&forced_declare,&scheme]
-                (const LongName &keyname, const vector<LongName> &deps) -> bool
+            string_view name = scheme.view(keyname);
+            size_t split = name.rfind("::");
+            string_view key = split==string_view::npos ? string_view() : name.substr(0,split+2);
+            const TypeInfo *info = scheme.info(keyname);
+            text.resize(info->translatedSize(key,name.substr(key.size())));
+            info->translate(text.data(),key,name.substr(key.size()));
+            print.add(name).add(info->getModule().view()).add(text);
+
+            Span<NameId> depends = scheme.dependencies(keyname);
+            print.add(depends.size());
+            for(NameId depname : depends)
             {
-                for(const LongName &depname : deps)
-                    if(completed.find(depname)==completed.end() && keyname!=depname)
-                        if(forced_declare.find(depname)!=forced_declare.end())return false;
-                        else
-                        {
-                            auto depend_it = scheme.find(depname);
-                            if(depend_it==scheme.end())throw NotFoundKeyError(depname);
-                            shared_ptr<TypeInfo> depinfo = depend_it->second;
-                            if(!depinfo->isExternal())return false;
-                        }
-                return true;
-            };
-            if(check_dependencies(keyname,info->dependencies()))
-                { code.declareForward(name); completed.insert(keyname); --incompleted_count; }
+                const TypeInfo *depinfo = scheme.info(depname);
+                print.add(scheme.view(depname));
+                if(scheme.isApplied(depname))print.add(uint64_t(0));
+                else if(depinfo && depinfo->isExternal())print.add(uint64_t(1)).add(depinfo->getModule().view());
+                else print.add(uint64_t(2));
+            }
         }
+        releaseLarge(text);
+        return make_shared<const string>(print.hex());
+    };
+    for(const auto &closure : requestClosures(declare_names,nullptr))
+    {
+        shared_ptr<const string> closure_digest = atomic_load(&closure->digest);
+        if(!closure_digest){ closure_digest = digest(*closure); atomic_store(&closure->digest,closure_digest); }
+        print.add(*closure_digest);
+        modules.insert(modules.end(),closure->modules.begin(),closure->modules.end());
+    }
 
-        for(auto& [childname,childnode] : attachments)if(childnode.incompleted_count>0)
+    //the edges of the module graph reached from the modules of the request, ordered by the names
+    vector<pair<string_view,string_view>> edges;
+    if(scheme.hasModuleGraph())
+    {
+        static thread_local NameMarks placed;
+        placed.reset(scheme.size());
+        while(!modules.empty())
         {
-            code.openNamespace(childname);
-            size_t childnode_incompleted = childnode.incompleted_count;
-            childnode.renderNode(code,completed,forced_declare,scheme,key+childname+"::");
-            incompleted_count -= childnode_incompleted - childnode.incompleted_count;
-            code.closeNamespace();
+            NameId module = modules.back(); modules.pop_back();
+            if(module==NoName || placed.test(module))continue;
+            placed.set(module);
+            for(NameId included : scheme.moduleIncludes(module))
+                { edges.emplace_back(scheme.view(module),scheme.view(included)); modules.push_back(included); }
         }
-    } while(incompleted_count<incompleted_prev && incompleted_count>0);
+        sort(edges.begin(),edges.end());
+    }
+    print.add(edges.size());
+    for(const auto & [module, included] : edges)print.add(module).add(included);
+    return print.hex();
 }
 
-IntermediateCode Codegen::code(
+string Codegen::source(const OutputCache &cache,
 	const vector<LongName> &include_names,
-	const vector<LongName> &declare_names) const
-{ 
-    IntermediateCode icode;
-    set<ModuleName> modules;
+	const vector<LongName> &declare_names,
+    CodegenStats *stats) const
+{
+    //the closure of a resolver is fetched once for the fingerprint and the generation
+    if(m_resolver)
+        return resolveScheme(requestNames(include_names,declare_names)).source(cache,include_names,declare_names,stats);
+    string key = fingerprint(include_names,declare_names), text;
+    if(cache.find(key,text))return text;
+    text = source(include_names,declare_names,stats);
+    cache.store(key,text);
+    return text;
+}
 
-    //make namespace tree
-    NamespaceModelNode root; queue<LongName> depends;
-    for(const LongName &name : declare_names)depends.push(name);
-    while(!depends.empty())
+void Codegen::addType(const LongName &keyname, shared_ptr<TypeInfo> info)
+{
+    if(findType(keyname))throw DuplicateKeyError(keyname);
+    update(keyname,move(info));
+}
+
+void Codegen::replaceType(const LongName &keyname, shared_ptr<TypeInfo> info)
+{
+    if(!findType(keyname))throw NotFoundKeyError(keyname);
+    update(keyname,move(info));
+}
+
+void Codegen::removeType(const LongName &keyname)
+{
+    if(!findType(keyname))throw NotFoundKeyError(keyname);
+    update(keyname,nullptr);
+}
+
+void Codegen::update(const LongName &keyname, shared_ptr<TypeInfo> info)
+{
+    //the reverse dependencies are built by the first change only
+    if(m_users.empty())
     {
-        auto forward_it = m_scheme.find(depends.front());
-        if(forward_it==m_scheme.end())throw NotFoundKeyError(depends.front());
-        shared_ptr<TypeInfo> info = forward_it->second; 
-        
-        if(root.placeForward(depends.front()))
+        m_users.resize(m_interned.size());
+        for(NameId id = 0; id<m_interned.size(); ++id)
+            for(NameId depname : m_interned.dependencies(id))m_users[depname].push_back(id);
+    }
+
+    //drop the memoized closures of the names which reach the key
+    NameId id = m_interned.find(keyname);
+    if(id!=NoName)
+    {
+        lock_guard lock(m_memo.mutex);
+        vector<bool> reached(m_users.size());
+        vector<NameId> depends{id}; reached[id] = true;
+        while(!depends.empty())
         {
-            modules.insert(info->getModule());
-            info->check(depends.front(),m_scheme);
-            for(const LongName &depname : info->dependencies())
-                if(m_some_fundamental.find(depname)==m_some_fundamental.end())
-                {
-                    auto depend_it = m_scheme.find(depname);
-                    if(depend_it==m_scheme.end())throw NotFoundKeyError(depname);
-                    shared_ptr<TypeInfo> depinfo = depend_it->second;
-                    if(depinfo->isExternal())modules.insert(depinfo->getModule());
-                    else depends.push(depname);
-                }
+            NameId depname = depends.back(); depends.pop_back();
+            m_memo.closures.erase(depname);
+            for(NameId username : m_users[depname])
+                if(!reached[username]){ reached[username] = true; depends.push_back(username); }
+        }
+        for(NameId depname : m_interned.dependencies(id))
+        {
+            vector<NameId> &users = m_users[depname];
+            users.erase(remove(begin(users),end(users),id),end(users));
         }
-        depends.pop();
     }
 
-    //render modules list
-    for(const LongName &keyname : include_names)
-        if(auto forward_it = m_scheme.find(keyname); forward_it==m_scheme.end())
-            throw NotFoundKeyError(keyname);
-        else modules.insert(forward_it->second->getModule());
-    for(const ModuleName &mname : modules)
-        if(mname.isPerfect())icode.includeModule(mname);
+    id = m_interned.assign(keyname,info.get());
+    if(m_users.size()<m_interned.size())m_users.resize(m_interned.size());
+    if(m_owners.size()<m_interned.size())m_owners.resize(m_interned.size());
+    m_owners[id] = info;
+    if(m_scheme_built){ if(info)m_scheme.insert_or_assign(keyname,info); else m_scheme.erase(keyname); }
 
-    //render namespaces and forwards
-    set<LongName> completed {m_some_fundamental};
-    set<LongName> forced_declare(begin(declare_names),end(declare_names));
-    root.renderNode(icode,completed,forced_declare,m_scheme);
-    if(root.incompleted_count>0)throw LoopForwardError();
+    //a removed type stays in the namespace index unreached, a new one needs the index rebuilt
+    {
+        lock_guard lock(m_memo.mutex);
+        if(info && m_memo.namespaces && m_memo.namespaces->nodeOf(id)==NamespaceIndex::NoNode)
+            m_memo.namespaces.reset();
+    }
+    for(NameId depname : m_interned.dependencies(id))m_users[depname].push_back(id);
 
-    return icode;
-}
\ No newline at end of file
+    //the check of a type sees its direct dependencies, so the users are checked again
+    SchemeLookup lookup(*this);
+    auto recheck = [this,&lookup](NameId checked)
+    {
+        m_rejected.erase(checked);
+        if(const TypeInfo *checked_info = m_interned.info(checked))
+            try { checked_info->check(m_interned.view(checked),lookup); }
+            catch(const exception &ex) { m_rejected.emplace(checked,Rejection{current_exception(),ex.what()}); }
+            catch(...) { m_rejected.emplace(checked,Rejection{current_exception(),"unknown error"}); }
+    };
+    recheck(id);
+    for(NameId username : m_users[id])recheck(username);
+}
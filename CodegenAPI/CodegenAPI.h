@@ -18,16 +18,14 @@ and 'CodegenAPI::FunctionTypeInfo' classes to describe the original meta informa
 and can be extended with new constructs by inheriting from the 'CodegenAPI::TypeInfo' class.
 When creating intermediate code, the correct and effective grouping and sorting of
 language constructs by the namespaces of the generated code is performed.
-A special greedy type algorithm is used for this. The required included libraries
+A topological scheduler is used for this. The required included libraries
 will be automatically connected. The contents of the intermediate code 
 'CodegenAPI::IntermediateCode' can then be checked using the 'verify' class method
 and converted to a text form using the 'translate' class method.
 
-The greedy algorithm used for translation is not optimal in terms
-of code generation quality and performance. This can be improved.
-Separate copies of 'std::string' are used to store meta-information keys,
-which requires a lot of memory. It is possible to create a hash table for storing
-parameters and store only pointers to its elements in the meta information.
+The meta-information keys are interned once into a 'CodegenAPI::NameTable',
+and the generation works on their compact identifiers. The other ways to load,
+generate and serve a scheme are described by their classes.
 */
 
 #ifndef CODEGEN_API_H
@@ -37,72 +35,456 @@ parameters and store only pointers to its elements in the meta information.
 #include <string>
 #include <map>
 #include <algorithm>
+#include <exception>
+#include <mutex>
+#include <unordered_map>
 
 #include "TypeInfo.h"
+#include "NameTable.h"
+#include "NamespaceIndex.h"
+#include "ModuleGraph.h"
+#include "OutputCache.h"
+#include "CodegenStats.h"
+#include "Diagnostics.h"
+#include "OutputSink.h"
+#include "SchemeArena.h"
+#include "Snapshot.h"
+#include "SchemeLoader.h"
+#include "SchemeResolver.h"
+#include "ThreadPool.h"
 
 namespace CodegenAPI
 {
+    //the names of a scheme interned once into its 'NameTable'; the types, the modules and the
+    //dependencies are kept by the 'NameId' identifiers the generation and the verification work on,
+    //the strings come back only when the intermediate code is translated
+    class InternedScheme
+    {
+    protected:
+        std::shared_ptr<NameTable> m_names;
+        std::shared_ptr<const Snapshot> m_snapshot;
+        std::vector<const TypeInfo*> m_infos;
+        std::vector<NameId> m_modules;
+        std::vector<std::pair<std::uint32_t,std::uint32_t>> m_depend_ranges;
+        std::vector<NameId> m_depend_edges;
+        std::size_t m_dropped_edges = 0;
+        std::vector<bool> m_applied;
+        std::unordered_map<NameId,std::vector<NameId>> m_module_includes;
+
+        void grow();
+        void compact();
+        void detach();
+        void apply(const std::set<LongName> &applied);
+        //the key and the dependencies kept by the arena are borrowed by the name table
+        NameId bind(std::string_view keyname, const TypeInfo *info, const SchemeArena *arena);
+        //the table shared with the copies of the scheme or with the codes is copied before it is changed
+        NameTable& ownNames();
+    public:
+        InternedScheme() : m_names(std::make_shared<NameTable>()) { }
+        InternedScheme(const std::map<LongName,std::shared_ptr<TypeInfo>> &scheme,
+            const std::set<LongName> &applied,
+            std::shared_ptr<NameTable> names = std::make_shared<NameTable>());
+        //the entries of the arena are sorted by their keys, so the names are interned in the order
+        //of a map; the name table refers to the names kept by the arena and keeps it alive
+        InternedScheme(const std::vector<std::pair<std::string_view,TypeInfo*>> &scheme,
+            const std::set<LongName> &applied, std::shared_ptr<const SchemeArena> arena);
+        //the arrays stay in the mapped snapshot until the first assignment copies them
+        explicit InternedScheme(std::shared_ptr<const Snapshot> snapshot)
+            : m_names(snapshot->names()), m_snapshot(std::move(snapshot)) { }
+
+        const std::shared_ptr<NameTable>& names() const { return m_names; }
+        std::size_t size() const { return m_snapshot ? m_snapshot->size() : m_infos.size(); }
+
+        NameId find(std::string_view name) const { return m_names->find(name); }
+        std::string_view view(NameId id) const { return m_names->view(id); }
+
+        const TypeInfo* info(NameId id) const
+        {
+            if(m_snapshot)return m_snapshot->info(id);
+            return id<m_infos.size() ? m_infos[id] : nullptr;
+        }
+        bool hasInfo(NameId id) const
+        {
+            if(m_snapshot)return m_snapshot->hasInfo(id);
+            return id<m_infos.size() && m_infos[id];
+        }
+        NameId module(NameId id) const
+        {
+            if(m_snapshot)return m_snapshot->module(id);
+            return id<m_modules.size() ? m_modules[id] : NoName;
+        }
+        Span<NameId> dependencies(NameId id) const
+        {
+            if(m_snapshot)return m_snapshot->dependencies(id);
+            if(id>=m_depend_ranges.size())return Span<NameId>();
+            const NameId *first = m_depend_edges.data()+m_depend_ranges[id].first;
+            return Span<NameId>(first,first+m_depend_ranges[id].second);
+        }
+        bool isApplied(NameId id) const
+        {
+            if(m_snapshot)return m_snapshot->isApplied(id);
+            return id<m_applied.size() && m_applied[id];
+        }
+
+        //binds the key to the type or unbinds it for the null type, the identifiers stay valid
+        NameId assign(std::string_view keyname, const TypeInfo *info) { return bind(keyname,info,nullptr); }
+
+        //the modules of the graph are interned by their names, the former graph is replaced
+        void setModuleGraph(const ModuleGraph &graph);
+        bool hasModuleGraph() const { return !m_module_includes.empty(); }
+        Span<NameId> moduleIncludes(NameId mname) const
+        {
+            auto includes_it = m_module_includes.find(mname);
+            if(includes_it==m_module_includes.end())return Span<NameId>();
+            const NameId *first = includes_it->second.data();
+            return Span<NameId>(first,first+includes_it->second.size());
+        }
+    };
+
     class IntermediateCode
     {
+        friend class Codegen;
     protected:
-        enum class Command { IncludeModule, OpenNamespace, ForwardDeclaration, CloseNamespace };
-        std::vector<std::pair<Command,std::string>> m_code;
+        enum class Command : std::uint32_t { IncludeModule, OpenNamespace, ForwardDeclaration, CloseNamespace };
+
+        //a command is one word, the opcode in the two high bits and the name identifier below them
+        static constexpr unsigned OperandBits = 30;
+        static constexpr std::uint32_t OperandMask = (std::uint32_t(1)<<OperandBits)-1;
+        static Command opcode(std::uint32_t word) { return static_cast<Command>(word>>OperandBits); }
+        static NameId operand(std::uint32_t word) { return word&OperandMask; }
+
+        std::vector<std::uint32_t> m_code;
+        std::shared_ptr<NameTable> m_names;
+        std::vector<NameId> m_spaces;
+        bool m_own_names;
+
+        NameId intern(std::string_view name);
+        void push(Command command, NameId operand = 0);
+        template <class Target> void replay(Target &target) const;
+        std::vector<LongName> forwardNames() const;
+
+        void translate(OutputSink &sink, const InternedScheme &scheme, CodegenStats *stats = nullptr) const;
+        //every command is sized before it is written, the text takes one allocation of its exact size
+        std::string translate(const InternedScheme &scheme, CodegenStats *stats = nullptr) const;
+        //without the diagnostics the first wrong command throws its error
+        bool verify(const InternedScheme &scheme,
+            const std::vector<LongName> &include_names, const std::vector<LongName> &declare_names,
+            CodegenStats *stats = nullptr, Diagnostics *diagnostics = nullptr) const;
     public:
-        IntermediateCode() = default;
+        IntermediateCode() : m_names(std::make_shared<NameTable>()), m_own_names(true) { }
+        explicit IntermediateCode(std::shared_ptr<NameTable> names)
+            : m_names(std::move(names)), m_own_names(false) { }
 
         void includeModule(const ModuleName &mname);
         void openNamespace(const std::string &name);
         void declareForward(const std::string &name);
         void closeNamespace();
 
-        std::string translate(const std::map<LongName,std::shared_ptr<TypeInfo>> &scheme) const;
+        //the identifiers are issued by the name table passed to the constructor
+        void includeModule(NameId mname);
+        void openNamespace(NameId space);
+        void declareForward(NameId keyname);
+
+        //the count of the commands, each of them takes four bytes
+        std::size_t size() const { return m_code.size(); }
+        //the codes sharing a name table are compared by their words, the others by the names
+        bool operator==(const IntermediateCode &other) const;
+        bool operator!=(const IntermediateCode &other) const { return !(*this==other); }
+
+        std::string translate(const std::map<LongName,std::shared_ptr<TypeInfo>> &scheme,
+            CodegenStats *stats = nullptr) const;
+        void translate(OutputSink &sink, const std::map<LongName,std::shared_ptr<TypeInfo>> &scheme,
+            CodegenStats *stats = nullptr) const;
         bool verify(
             const std::map<LongName,std::shared_ptr<TypeInfo>> &scheme,
             const std::vector<LongName> &include_names, const std::vector<LongName> &declare_names,
-            const std::set<LongName> &applied) const;
+            const std::set<LongName> &applied, CodegenStats *stats = nullptr) const;
+        //a module is taken as included when an included module includes it by the graph
+        bool verify(
+            const std::map<LongName,std::shared_ptr<TypeInfo>> &scheme,
+            const std::vector<LongName> &include_names, const std::vector<LongName> &declare_names,
+            const std::set<LongName> &applied, const ModuleGraph &modules, CodegenStats *stats = nullptr) const;
+        //every wrong command is listed instead of throwing the first one
+        Diagnostics diagnose(
+            const std::map<LongName,std::shared_ptr<TypeInfo>> &scheme,
+            const std::vector<LongName> &include_names, const std::vector<LongName> &declare_names,
+            const std::set<LongName> &applied, CodegenStats *stats = nullptr) const;
+        Diagnostics diagnose(
+            const std::map<LongName,std::shared_ptr<TypeInfo>> &scheme,
+            const std::vector<LongName> &include_names, const std::vector<LongName> &declare_names,
+            const std::set<LongName> &applied, const ModuleGraph &modules, CodegenStats *stats = nullptr) const;
+
+        //the types of the forwards and of the request are fetched from the resolver
+        std::string translate(SchemeResolver &resolver, CodegenStats *stats = nullptr) const;
+        void translate(OutputSink &sink, SchemeResolver &resolver, CodegenStats *stats = nullptr) const;
+        bool verify(SchemeResolver &resolver,
+            const std::vector<LongName> &include_names, const std::vector<LongName> &declare_names,
+            const std::set<LongName> &applied, CodegenStats *stats = nullptr) const;
+    };
+
+    //the code of a request rendered as far as its problems let it and all the problems found
+    struct CodeResult
+    {
+        IntermediateCode code;
+        Diagnostics diagnostics;
+
+        bool ok() const { return diagnostics.empty(); }
     };
 
+    struct CodeRequest
+    {
+        std::vector<LongName> include_names;
+        std::vector<LongName> declare_names;
+    };
+
+    //the forwards are split into the count of shards of about the same size,
+    //or into the shards of at most the budget of forwards when it is given
+    struct ShardOptions
+    {
+        std::size_t count = 1;
+        std::size_t budget = 0;
+        std::string prefix = "shard";
+    };
+
+    struct Shard
+    {
+        //the header is named by the prefix and the index, as "shard_0.h"
+        std::string name;
+        std::vector<std::string> includes;
+        std::vector<LongName> forwards;
+        std::string text;
+    };
+
+    //the scheme is loaded from a map, a 'SchemeArena', a 'Snapshot' mapped without parsing or
+    //a 'SchemeResolver' fetching the types on their first use; the scheduler builds the dependency
+    //graph of the declared forwards once and emits every forward as soon as its dependencies are
+    //complete, preferring the namespace being rendered, so the namespaces are reopened only when
+    //the dependencies demand it
 	class Codegen
 	{
 	protected:
-        struct NamespaceModelNode;
+        struct NamespaceSchedule;
+        struct ForwardGraph;
+        struct Closure;
 
-        std::map<LongName,std::shared_ptr<TypeInfo>> m_scheme;
+        //the memoized closures of the declared names and the namespace index of the scheme,
+        //a copy of the generator starts with an empty memo
+        struct ClosureMemo
+        {
+            std::mutex mutex;
+            std::unordered_map<NameId,std::shared_ptr<const Closure>> closures;
+            std::shared_ptr<const NamespaceIndex> namespaces;
+
+            ClosureMemo() = default;
+            ClosureMemo(const ClosureMemo&) { }
+            ClosureMemo& operator=(const ClosureMemo&)
+                { std::lock_guard lock(mutex); closures.clear(); namespaces.reset(); return *this; }
+        };
+
+        std::shared_ptr<SchemeArena> m_arena;
+        std::shared_ptr<const Snapshot> m_snapshot;
+        //the ordered scheme is filled by the first 'getSheme' and kept by the edits after it
+        mutable std::map<LongName,std::shared_ptr<TypeInfo>> m_scheme;
+        mutable bool m_scheme_built = false;
+        //the types which are not owned by the arena or the snapshot, by the identifiers of their keys
+        std::vector<std::shared_ptr<TypeInfo>> m_owners;
         std::set<LongName> m_some_fundamental = 
             {"void", "char", "int", "long", "long long", "unsigned", "size_t", "float", "double"};
+        InternedScheme m_interned;
+        //the error of the check of a type and its message
+        struct Rejection
+        {
+            std::exception_ptr error;
+            std::string message;
+        };
+
+        //the pool of the batches made by the first of them for the thread count asked,
+        //a copy of the generator makes its own
+        struct BatchPool
+        {
+            std::mutex mutex;
+            std::shared_ptr<ThreadPool> pool;
+            unsigned threads = 0;
+
+            BatchPool() = default;
+            BatchPool(const BatchPool&) { }
+            BatchPool& operator=(const BatchPool&) { return *this; }
+        };
+
+        std::map<NameId,Rejection> m_rejected;
+        std::vector<std::vector<NameId>> m_users;
+        ModuleGraph m_module_graph;
+        mutable ClosureMemo m_memo;
+        mutable BatchPool m_batch_pool;
+        bool m_verification = false;
+        std::shared_ptr<SchemeResolver> m_resolver;
+
+        void load(const std::map<LongName,std::shared_ptr<TypeInfo>> &scheme);
+        void checkTypes();
+        void update(const LongName &keyname, std::shared_ptr<TypeInfo> info);
+        //the generator over the types reached from the names, the types of the scheme go first;
+        //it is built for every request, so the closure is interned and checked again each time
+        //and the closures of a resolver generator are never memoized
+        Codegen resolveScheme(const std::vector<LongName> &names) const;
+        Codegen resolveScheme(const std::vector<CodeRequest> &requests) const;
+        //the problems are listed by the diagnostics when they are passed, and thrown at once otherwise;
+        //a closure with problems is not memoized
+        std::vector<NameId> resolveDeclared(const std::vector<LongName> &declare_names,
+            Diagnostics *diagnostics = nullptr) const;
+        Closure collectClosure(const std::vector<NameId> &roots, Diagnostics *diagnostics = nullptr) const;
+        //the calls running on an older pool keep it until they return
+        std::shared_ptr<ThreadPool> batchPool(unsigned threads) const;
+        //the problem of the closures the throwing methods report, the first one met walking
+        //the declared names and their dependencies breadth first, or null without problems
+        std::exception_ptr closureError(const std::vector<LongName> &declare_names) const;
+        std::shared_ptr<const NamespaceIndex> namespaces() const;
+        std::shared_ptr<const Closure> rootClosure(NameId root, CodegenStats *stats = nullptr,
+            Diagnostics *diagnostics = nullptr) const;
+        std::vector<std::shared_ptr<const Closure>> requestClosures(
+            const std::vector<LongName> &declare_names, CodegenStats *stats, Diagnostics *diagnostics = nullptr) const;
+        //the target is the intermediate code or the writer of the text
+        template <class Target> void renderCode(Target &target, const std::vector<const Closure*> &closures,
+            const std::vector<LongName> &include_names, const std::vector<LongName> &declare_names,
+            CodegenStats *stats = nullptr, Diagnostics *diagnostics = nullptr) const;
+        //renders into the target and checks the commands on the way when the verification is on
+        template <class Target> void generate(Target &target, const std::vector<const Closure*> &closures,
+            const std::vector<LongName> &include_names, const std::vector<LongName> &declare_names,
+            CodegenStats *stats = nullptr, Diagnostics *diagnostics = nullptr) const;
+        IntermediateCode generateCode(const std::vector<LongName> &include_names,
+            const std::vector<LongName> &declare_names, CodegenStats *stats, Diagnostics *diagnostics) const;
+        bool verifyRequest(const std::vector<LongName> &include_names,
+            const std::vector<LongName> &declare_names, CodegenStats *stats, Diagnostics *diagnostics) const;
+        //the throwing methods collect the problems and raise the first of them
+        void raiseFirst(const Diagnostics &diagnostics, const std::vector<LongName> &declare_names) const;
+        template <class Render> void renderBatch(const std::vector<CodeRequest> &requests, ThreadPool &pool,
+            Render render) const;
+        //renders the text in place into the buffer of the thread, the text takes one allocation
+        std::string renderText(const std::vector<const Closure*> &closures,
+            const std::vector<LongName> &include_names, const std::vector<LongName> &declare_names,
+            CodegenStats *stats = nullptr) const;
 
         template <class Iter> Codegen(Iter first, Iter last) 
         {
-            std::for_each(first,last,[this](const std::pair<LongName,std::shared_ptr<TypeInfo>>& i)
+            std::map<LongName,std::shared_ptr<TypeInfo>> scheme;
+            std::for_each(first,last,[&scheme](const std::pair<LongName,std::shared_ptr<TypeInfo>>& i)
             {
                 const auto & [keyname, info] = i;
-                if(!m_scheme.try_emplace(keyname,info).second)throw DuplicateKeyError(keyname);
+                if(!scheme.try_emplace(keyname,info).second)throw DuplicateKeyError(keyname);
             });
+            load(scheme);
         }
 	public:
-		Codegen(const std::map<LongName,std::shared_ptr<TypeInfo>> &scheme)
-            : m_scheme(scheme) { }
-		Codegen(std::map<LongName,std::shared_ptr<TypeInfo>> &&scheme)
-            : m_scheme(std::move(scheme)) { }
+		Codegen(const std::map<LongName,std::shared_ptr<TypeInfo>> &scheme) { load(scheme); }
+		Codegen(std::map<LongName,std::shared_ptr<TypeInfo>> &&scheme) { load(scheme); }
         Codegen(std::initializer_list<std::pair<LongName,std::shared_ptr<TypeInfo>>> scheme)
             : Codegen(std::begin(scheme),std::end(scheme)) { }
 		Codegen(const std::vector<std::pair<LongName,std::shared_ptr<TypeInfo>>> &scheme)
             : Codegen(std::begin(scheme),std::end(scheme)) { }
+        //the scheme shares the arena, the types are referred to without own reference counts
+        Codegen(std::shared_ptr<SchemeArena> arena);
+        //the lookups and the generation are served from the mapped snapshot
+        explicit Codegen(std::shared_ptr<const Snapshot> snapshot);
+        //every request is generated over the closure of its names fetched from the resolver,
+        //the types added to the generator are taken before the resolved ones; every request
+        //builds a generator of its closure, so a resolver should be wrapped by a 'CachedResolver'
+        //when the same names are asked for again
+        explicit Codegen(std::shared_ptr<SchemeResolver> resolver) : m_resolver(std::move(resolver)) { load({}); }
 
+        //the statistics, when they are passed, accumulate the phases of the call;
+        //'source' renders the text straight into the sink without the intermediate code,
+        //so on a dependency loop the sink can keep the text written before it was found;
+        //the text returned is rendered the same way into one allocation of its exact size
 		IntermediateCode code(
 			const std::vector<LongName> &include_names,
-			const std::vector<LongName> &declare_names) const;
+			const std::vector<LongName> &declare_names,
+            CodegenStats *stats = nullptr) const;
+        //the generation goes on past the problems, which are all returned with the code;
+        //'code' raises the first of them
+        CodeResult tryCode(
+			const std::vector<LongName> &include_names,
+			const std::vector<LongName> &declare_names,
+            CodegenStats *stats = nullptr) const;
 		std::string source(
 			const std::vector<LongName> &include_names,
-			const std::vector<LongName> &declare_names) const
-            { return code(include_names,declare_names).translate(m_scheme); }
+			const std::vector<LongName> &declare_names,
+            CodegenStats *stats = nullptr) const;
+		void source(OutputSink &sink,
+			const std::vector<LongName> &include_names,
+			const std::vector<LongName> &declare_names,
+            CodegenStats *stats = nullptr) const;
+        //the requests are generated on the pool, the closures of the shared names are collected once;
+        //the first failed request in order rethrows its error; without a pool the generator keeps one
+        std::vector<IntermediateCode> codeBatch(const std::vector<CodeRequest> &requests, ThreadPool &pool) const;
+        std::vector<IntermediateCode> codeBatch(const std::vector<CodeRequest> &requests, unsigned threads = 0) const
+            { return codeBatch(requests,*batchPool(threads)); }
+        std::vector<std::string> sourceBatch(const std::vector<CodeRequest> &requests, ThreadPool &pool) const;
+        std::vector<std::string> sourceBatch(const std::vector<CodeRequest> &requests, unsigned threads = 0) const
+            { return sourceBatch(requests,*batchPool(threads)); }
+
+        //the forwards of the namespaces are kept together and the dependency loops stay in one shard;
+        //a shard includes the modules of its own forwards and the former shards it depends on,
+        //the modules of the forced includes go to the first shard; the shards are rendered on the pool
+        std::vector<Shard> sourceShards(const std::vector<LongName> &include_names,
+            const std::vector<LongName> &declare_names, const ShardOptions &options, ThreadPool &pool) const;
+        std::vector<Shard> sourceShards(const std::vector<LongName> &include_names,
+            const std::vector<LongName> &declare_names, const ShardOptions &options, unsigned threads = 0) const
+            { return sourceShards(include_names,declare_names,options,*batchPool(threads)); }
+
+        //the fingerprint of the request over the types of its dependency closure, the modules they
+        //need and the module graph over these modules, the rest of the scheme does not change it
+        std::string fingerprint(const std::vector<LongName> &include_names,
+            const std::vector<LongName> &declare_names) const;
+        //the text is taken from the cache by the fingerprint, or generated and stored on a miss
+        std::string source(const OutputCache &cache,
+			const std::vector<LongName> &include_names,
+			const std::vector<LongName> &declare_names,
+            CodegenStats *stats = nullptr) const;
+        //the file is replaced atomically when its text changes, returns whether it was written
+        bool writeSource(const std::string &path, const OutputCache &cache,
+			const std::vector<LongName> &include_names,
+			const std::vector<LongName> &declare_names,
+            CodegenStats *stats = nullptr) const
+            { return OutputCache::replace(path,source(cache,include_names,declare_names,stats)); }
+
+        //the scheme is changed in place, only the memoized closures which reach the key are dropped;
+        //the changes must not run concurrently with the generation
+        void addType(const LongName &keyname, std::shared_ptr<TypeInfo> info);
+        void replaceType(const LongName &keyname, std::shared_ptr<TypeInfo> info);
+        void removeType(const LongName &keyname);
+        void clearClosures() { std::lock_guard lock(m_memo.mutex); m_memo.closures.clear(); }
+
+        //checks the commands as they are rendered without keeping the code, returns true
+        //or throws the error of the first wrong command
 		bool test(
 			const std::vector<LongName> &include_names,
-			const std::vector<LongName> &declare_names) const
-            { return code(include_names,declare_names)
-                    .verify(m_scheme,include_names,declare_names,m_some_fundamental); }
+			const std::vector<LongName> &declare_names,
+            CodegenStats *stats = nullptr) const;
+        //checks the request as 'test' does and lists all its problems in one run
+        Diagnostics diagnose(
+			const std::vector<LongName> &include_names,
+			const std::vector<LongName> &declare_names,
+            CodegenStats *stats = nullptr) const;
+        //the types of the scheme rejected by their checks, in the order of their names
+        Diagnostics diagnoseScheme() const;
+        //the generation checks every command as it is rendered in constant time per dependency
+        //and throws the error of the first wrong command
+        void setVerification(bool verification) { m_verification = verification; }
+        bool getVerification() const { return m_verification; }
+
+        //the modules included by another emitted module are not emitted, the graph is not
+        //kept by the snapshot; the changes must not run concurrently with the generation
+        void setModuleGraph(ModuleGraph graph)
+            { m_module_graph = std::move(graph); m_interned.setModuleGraph(m_module_graph); }
+        const ModuleGraph& getModuleGraph() const { return m_module_graph; }
+
+        //writes the binary snapshot of the scheme, which 'Snapshot::open' maps back
+        void save(OutputSink &sink) const;
 
-        const std::map<LongName,std::shared_ptr<TypeInfo>>& getSheme() const { return m_scheme; }
+        //the ordered view of the scheme, the lookups go through the hashed name table
+        const std::map<LongName,std::shared_ptr<TypeInfo>>& getSheme() const;
+        const TypeInfo* findType(std::string_view keyname) const
+            { return m_interned.info(m_interned.find(keyname)); }
+        const NameTable& getNames() const { return *m_interned.names(); }
 	};
 }
 
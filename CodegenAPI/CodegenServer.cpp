@@ -0,0 +1,468 @@
+/*
+file:   CodegenServer.cpp
+
+author:	Aleksey Yakovlev
+data:	October 16, 2026
+
+Resident generation server and its client for a task on the topic of code generation.
+*/
+
+#include "pch.h"
+#include "CodegenServer.h"
+
+#include <cstring>
+#ifdef _WIN32
+#include <winsock2.h>
+#include <afunix.h>
+#include <io.h>
+#pragma comment(lib,"ws2_32.lib")
+#else
+#include <cerrno>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+using namespace CodegenAPI;
+using namespace std;
+
+
+
+enum class FrameKind : char { Request = 'R', Text = 'T', Done = 'D', Error = 'E' };
+
+static constexpr size_t FrameHeaderSize = 5;
+//a frame longer than the limit is taken for a broken stream
+static constexpr uint32_t MaxFrameSize = uint32_t(1)<<30;
+//the poll is woken by the shutdown of the listener, the timeout only bounds the wait for 'stop'
+//where it is not
+static constexpr int PollTimeout = 250;
+
+#ifdef _WIN32
+using NativeSocket = SOCKET;
+static NativeSocket native(SocketHandle socket) { return static_cast<NativeSocket>(socket); }
+
+static void startSockets()
+{
+    struct Startup
+    {
+        Startup() { WSADATA data; if(WSAStartup(MAKEWORD(2,2),&data)!=0)throw SocketError("startup"); }
+        ~Startup() { WSACleanup(); }
+    };
+    static Startup startup;
+}
+
+static void closeSocket(SocketHandle socket) { closesocket(native(socket)); }
+static void shutdownSocket(SocketHandle socket) { shutdown(native(socket),SD_BOTH); }
+static void removePath(const string &path) { _unlink(path.c_str()); }
+
+using PollEntry = WSAPOLLFD;
+static int pollSockets(vector<PollEntry> &entries)
+    { return WSAPoll(entries.data(),static_cast<ULONG>(entries.size()),PollTimeout); }
+#else
+using NativeSocket = int;
+static NativeSocket native(SocketHandle socket) { return static_cast<NativeSocket>(socket); }
+
+static void startSockets() { }
+static void closeSocket(SocketHandle socket) { ::close(native(socket)); }
+static void shutdownSocket(SocketHandle socket) { shutdown(native(socket),SHUT_RDWR); }
+static void removePath(const string &path) { ::unlink(path.c_str()); }
+
+using PollEntry = pollfd;
+static int pollSockets(vector<PollEntry> &entries)
+    { return ::poll(entries.data(),static_cast<nfds_t>(entries.size()),PollTimeout); }
+#endif
+
+static sockaddr_un socketAddress(const string &path)
+{
+    sockaddr_un address;
+    memset(&address,0,sizeof(address));
+    address.sun_family = AF_UNIX;
+    if(path.empty() || path.size()>=sizeof(address.sun_path))throw SocketError("bad path "+path);
+    memcpy(address.sun_path,path.data(),path.size());
+    return address;
+}
+
+static SocketHandle openSocket()
+{
+    startSockets();
+    SocketHandle handle = static_cast<SocketHandle>(socket(AF_UNIX,SOCK_STREAM,0));
+    if(handle==-1)throw SocketError("socket");
+    return handle;
+}
+
+static void sendAll(SocketHandle socket, const char *data, size_t size)
+{
+    while(size>0)
+    {
+#ifdef _WIN32
+        int count = send(native(socket),data,static_cast<int>(min<size_t>(size,1<<30)),0);
+#else
+        ssize_t count = send(native(socket),data,size,MSG_NOSIGNAL);
+        if(count<0 && errno==EINTR)continue;
+#endif
+        if(count<=0)throw SocketError("send");
+        data += count; size -= static_cast<size_t>(count);
+    }
+}
+
+//false when the peer has closed the connection before the first byte
+static bool receiveAll(SocketHandle socket, char *data, size_t size)
+{
+    for(size_t done=0; done<size;)
+    {
+#ifdef _WIN32
+        int count = recv(native(socket),data+done,static_cast<int>(min<size_t>(size-done,1<<30)),0);
+#else
+        ssize_t count = recv(native(socket),data+done,size-done,0);
+        if(count<0 && errno==EINTR)continue;
+#endif
+        if(count==0 && done==0)return false;
+        if(count<=0)throw SocketError("receive");
+        done += static_cast<size_t>(count);
+    }
+    return true;
+}
+
+//the count of the bytes read by one call, zero when the peer has closed the connection
+static size_t receiveSome(SocketHandle socket, char *data, size_t size)
+{
+    for(;;)
+    {
+#ifdef _WIN32
+        int count = recv(native(socket),data,static_cast<int>(min<size_t>(size,1<<30)),0);
+#else
+        ssize_t count = recv(native(socket),data,size,0);
+        if(count<0 && errno==EINTR)continue;
+#endif
+        if(count<0)throw SocketError("receive");
+        return static_cast<size_t>(count);
+    }
+}
+
+static uint32_t payloadSize(const char header[])
+{
+    uint32_t size = 0;
+    for(size_t i=0; i<4; ++i)size |= uint32_t(static_cast<unsigned char>(header[1+i]))<<(8*i);
+    return size;
+}
+
+static void sendFrame(SocketHandle socket, FrameKind kind, string_view payload)
+{
+    char header[FrameHeaderSize] = {static_cast<char>(kind)};
+    uint32_t size = static_cast<uint32_t>(payload.size());
+    for(size_t i=0; i<4; ++i)header[1+i] = static_cast<char>(size>>(8*i));
+    sendAll(socket,header,sizeof(header));
+    sendAll(socket,payload.data(),payload.size());
+}
+
+//false when the peer has closed the connection between the frames
+static bool receiveFrame(SocketHandle socket, FrameKind &kind, string &payload)
+{
+    char header[FrameHeaderSize];
+    if(!receiveAll(socket,header,sizeof(header)))return false;
+    uint32_t size = payloadSize(header);
+    if(size>MaxFrameSize)throw SocketError("frame size");
+    kind = static_cast<FrameKind>(header[0]);
+    payload.resize(size);
+    if(size>0 && !receiveAll(socket,payload.data(),size))throw SocketError("receive");
+    return true;
+}
+
+static void putWord(string &payload, uint32_t word)
+    { for(size_t i=0; i<4; ++i)payload.push_back(static_cast<char>(word>>(8*i))); }
+
+static uint32_t takeWord(string_view &payload)
+{
+    if(payload.size()<4)throw SocketError("request");
+    uint32_t word = 0;
+    for(size_t i=0; i<4; ++i)word |= uint32_t(static_cast<unsigned char>(payload[i]))<<(8*i);
+    payload.remove_prefix(4); return word;
+}
+
+static string encodeRequest(const vector<LongName> &include_names, const vector<LongName> &declare_names)
+{
+    string payload;
+    putWord(payload,static_cast<uint32_t>(include_names.size()));
+    putWord(payload,static_cast<uint32_t>(declare_names.size()));
+    for(const vector<LongName> *names : {&include_names,&declare_names})
+        for(const LongName &name : *names){ putWord(payload,static_cast<uint32_t>(name.size())); payload += name; }
+    return payload;
+}
+
+static CodeRequest decodeRequest(string_view payload)
+{
+    CodeRequest request;
+    uint32_t include_count = takeWord(payload), declare_count = takeWord(payload);
+    if(uint64_t(include_count)+declare_count>payload.size()/4)throw SocketError("request");
+    for(uint32_t i=0; i<include_count+declare_count; ++i)
+    {
+        uint32_t size = takeWord(payload);
+        if(size>payload.size())throw SocketError("request");
+        (i<include_count ? request.include_names : request.declare_names).emplace_back(payload.substr(0,size));
+        payload.remove_prefix(size);
+    }
+    if(!payload.empty())throw SocketError("request");
+    return request;
+}
+
+//passes every chunk of the text to the client as a text frame
+class SocketSink : public OutputSink
+{
+protected:
+    SocketHandle m_socket;
+    void drain() override
+    {
+        if(m_buffer.empty())return;
+        sendFrame(m_socket,FrameKind::Text,m_buffer); m_buffer.clear();
+    }
+public:
+    explicit SocketSink(SocketHandle socket, size_t chunk = 1<<16) : OutputSink(chunk), m_socket(socket) { }
+};
+
+struct CodegenServer::Connection
+{
+    SocketHandle socket;
+    //the bytes read and not yet taken by a worker
+    string input;
+    //a worker answers the requests of the connection, it takes the next one when it is done
+    bool busy = false;
+    //nothing more is read, the socket is closed when the worker is done
+    bool ended = false;
+
+    explicit Connection(SocketHandle client) : socket(client) { }
+
+    //the size of the request frame which has come completely first, zero when there is none;
+    //a frame of another kind ends the connection
+    size_t request()
+    {
+        if(input.size()<FrameHeaderSize)return 0;
+        uint32_t size = payloadSize(input.data());
+        if(static_cast<FrameKind>(input[0])!=FrameKind::Request || size>MaxFrameSize)
+        {
+            input.clear(); ended = true;
+            return 0;
+        }
+        return input.size()-FrameHeaderSize>=size ? FrameHeaderSize+size : 0;
+    }
+};
+
+
+
+CodegenServer::CodegenServer(const Codegen &codegen, const string &path, unsigned threads)
+    : m_codegen(&codegen), m_shared(nullptr), m_path(path), m_listener(-1), m_stopped(false), m_pool(threads)
+{
+    listenAt(path);
+}
+
+CodegenServer::CodegenServer(SharedCodegen &shared, const string &path, unsigned threads)
+    : m_codegen(nullptr), m_shared(&shared), m_path(path), m_listener(-1), m_stopped(false), m_pool(threads)
+{
+    listenAt(path);
+}
+
+void CodegenServer::listenAt(const string &path)
+{
+    sockaddr_un address = socketAddress(path);
+    m_listener = openSocket();
+    removePath(path);
+    if(::bind(native(m_listener),reinterpret_cast<const sockaddr*>(&address),sizeof(address))!=0 ||
+        listen(native(m_listener),SOMAXCONN)!=0)
+    {
+        closeSocket(m_listener);
+        throw SocketError("bind "+path);
+    }
+}
+
+CodegenServer::~CodegenServer()
+{
+    //the connections are shut down, so the pool is joined as soon as the workers see it
+    stop();
+    if(m_listener!=-1)closeSocket(m_listener);
+}
+
+void CodegenServer::serve()
+{
+    //the listener is the first entry, then the connections which are read
+    vector<PollEntry> entries;
+    vector<shared_ptr<Connection>> polled;
+    try
+    {
+        while(!m_stopped)
+        {
+            entries.assign(1,PollEntry{native(m_listener),POLLIN,0});
+            polled.clear();
+            {
+                lock_guard lock(m_mutex);
+                for(auto & [client, connection] : m_clients)
+                    if(!connection->ended){ entries.push_back({native(client),POLLIN,0}); polled.push_back(connection); }
+            }
+            if(pollSockets(entries)<0)
+            {
+#ifndef _WIN32
+                if(errno==EINTR)continue;
+#endif
+                if(m_stopped)break;
+                throw SocketError("poll");
+            }
+            for(size_t i=1; i<entries.size(); ++i)
+                if(entries[i].revents!=0)receive(polled[i-1]);
+            if(entries[0].revents==0 || m_stopped)continue;
+
+            SocketHandle client = static_cast<SocketHandle>(accept(native(m_listener),nullptr,nullptr));
+            if(client==-1)
+            {
+#ifndef _WIN32
+                if(errno==EINTR || errno==ECONNABORTED)continue;
+#endif
+                if(m_stopped)break;
+                throw SocketError("accept");
+            }
+            lock_guard lock(m_mutex);
+            if(m_stopped){ closeSocket(client); break; }
+            m_clients.emplace(client,make_shared<Connection>(client));
+        }
+    }
+    catch(...) { closeAll(); throw; }
+    closeAll();
+}
+
+void CodegenServer::stop()
+{
+    //the listener is closed when 'serve' returns, so its poll never sees the handle reused
+    lock_guard lock(m_mutex);
+    if(m_stopped.exchange(true))return;
+    if(m_listener!=-1)shutdownSocket(m_listener);
+    removePath(m_path);
+    for(auto & [client, connection] : m_clients)shutdownSocket(client);
+}
+
+void CodegenServer::receive(const shared_ptr<Connection> &connection)
+{
+    //a readable socket does not block the read, which is done under the lock,
+    //so the socket cannot be closed by a worker meanwhile
+    char buffer[1<<14];
+    lock_guard lock(m_mutex);
+    if(connection->ended)return;
+    size_t count = 0;
+    try { count = receiveSome(connection->socket,buffer,sizeof(buffer)); }
+    catch(const SocketError&) { }
+    if(count==0)connection->ended = true;
+    else connection->input.append(buffer,count);
+
+    if(connection->busy)return;
+    if(connection->request()>0)
+    {
+        connection->busy = true;
+        m_pool.submit([this,connection]() { serveRequests(connection); });
+    }
+    else if(connection->ended)release(*connection);
+}
+
+void CodegenServer::serveRequests(shared_ptr<Connection> connection)
+{
+    //the errors of a connection end it, the errors of a request are reported to the client
+    string payload;
+    for(;;)
+    {
+        {
+            lock_guard lock(m_mutex);
+            size_t size = connection->request();
+            if(size==0)
+            {
+                connection->busy = false;
+                if(connection->ended)release(*connection);
+                return;
+            }
+            payload.assign(connection->input,FrameHeaderSize,size-FrameHeaderSize);
+            connection->input.erase(0,size);
+        }
+
+        try
+        {
+            CodeRequest request = decodeRequest(payload);
+            SocketSink sink(connection->socket);
+            string error;
+            try
+            {
+                if(m_shared)m_shared->source(sink,request.include_names,request.declare_names);
+                else m_codegen->source(sink,request.include_names,request.declare_names);
+            }
+            catch(const SocketError&) { throw; }
+            catch(const exception &ex) { error = ex.what(); }
+            catch(...) { error = "Unknown error"; }
+            sink.flush();
+            sendFrame(connection->socket,error.empty() ? FrameKind::Done : FrameKind::Error,error);
+        }
+        catch(...)
+        {
+            lock_guard lock(m_mutex);
+            connection->input.clear();
+            connection->ended = true;
+            connection->busy = false;
+            release(*connection);
+            return;
+        }
+    }
+}
+
+void CodegenServer::release(Connection &connection)
+{
+    //called under the lock for an ended connection without a worker
+    SocketHandle socket = connection.socket;
+    closeSocket(socket);
+    m_clients.erase(socket);
+}
+
+void CodegenServer::closeAll()
+{
+    //the clients still waiting to be accepted are refused by closing the listener,
+    //the connections with a worker are closed by it when it is done
+    lock_guard lock(m_mutex);
+    closeSocket(m_listener);
+    m_listener = -1;
+    for(auto it = m_clients.begin(); it!=m_clients.end();)
+    {
+        Connection &connection = *(it++)->second;
+        connection.input.clear();
+        connection.ended = true;
+        if(!connection.busy)release(connection);
+    }
+}
+
+
+
+CodegenClient::CodegenClient(const string &path) : m_socket(-1)
+{
+    sockaddr_un address = socketAddress(path);
+    m_socket = openSocket();
+    if(connect(native(m_socket),reinterpret_cast<const sockaddr*>(&address),sizeof(address))!=0)
+    {
+        closeSocket(m_socket);
+        throw SocketError("connect "+path);
+    }
+}
+
+CodegenClient::~CodegenClient()
+{
+    closeSocket(m_socket);
+}
+
+void CodegenClient::source(OutputSink &sink,
+    const vector<LongName> &include_names, const vector<LongName> &declare_names)
+{
+    sendFrame(m_socket,FrameKind::Request,encodeRequest(include_names,declare_names));
+    FrameKind kind;
+    string payload;
+    for(;;)
+    {
+        if(!receiveFrame(m_socket,kind,payload))throw SocketError("connection closed");
+        switch(kind)
+        {
+        case FrameKind::Text: sink<<payload; break;
+        case FrameKind::Done: sink.flush(); return;
+        case FrameKind::Error: sink.flush(); throw RemoteError(payload);
+        default: throw SocketError("unexpected frame");
+        }
+    }
+}
@@ -0,0 +1,102 @@
+/*
+file:   CodegenServer.h
+
+author:	Aleksey Yakovlev
+data:	October 16, 2026
+
+Resident generation server and its client for a task on the topic of code generation.
+
+The server keeps one 'Codegen' and answers the requests of the clients over a local
+Unix domain socket, so the scheme is built once for many generations. The protocol
+is a sequence of frames, a frame is a kind byte, the length of the payload in four
+little-endian bytes and the payload:
+
+    'R'  request    the count of the include names and of the declare names
+                    in four bytes each, then every name by its length and its bytes
+    'T'  text       the next chunk of the generated text
+    'D'  done       the text of the request is complete, the payload is empty
+    'E'  error      the message of the error of the request
+
+A client sends a request and reads the text frames up to a done or an error frame,
+then may send the next request over the same connection. The text is streamed as it
+is rendered by 'Codegen::source', so the text written before an error is kept.
+
+The thread of 'serve' polls the listener and all the connections and reads what comes,
+only a complete request frame is passed to a worker of the pool, which sends the answer
+and takes the next request already read on the connection, if any. An idle connection
+holds no worker, so the count of the clients is not limited by the pool. A server of a
+'SharedCodegen' generates every request from the version current when it comes,
+so the scheme can be reloaded while the server runs.
+*/
+
+#ifndef CODEGEN_SERVER_H
+#define CODEGEN_SERVER_H
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "CodegenAPI.h"
+#include "SharedCodegen.h"
+
+namespace CodegenAPI
+{
+    //a socket handle of the platform, an invalid handle is -1
+    using SocketHandle = std::intptr_t;
+
+    class CodegenServer
+    {
+    protected:
+        const Codegen *m_codegen;
+        SharedCodegen *m_shared;
+        std::string m_path;
+        SocketHandle m_listener;
+        //the bytes read from a client and the state of its requests
+        struct Connection;
+        std::mutex m_mutex;
+        std::map<SocketHandle,std::shared_ptr<Connection>> m_clients;
+        std::atomic<bool> m_stopped;
+        ThreadPool m_pool;
+
+        void listenAt(const std::string &path);
+        void receive(const std::shared_ptr<Connection> &connection);
+        void serveRequests(std::shared_ptr<Connection> connection);
+        void release(Connection &connection);
+        void closeAll();
+    public:
+        //binds the socket path, a file left at the path by a former server is replaced
+        CodegenServer(const Codegen &codegen, const std::string &path, unsigned threads = 0);
+        CodegenServer(SharedCodegen &shared, const std::string &path, unsigned threads = 0);
+        CodegenServer(const CodegenServer&) = delete;
+        CodegenServer& operator=(const CodegenServer&) = delete;
+        ~CodegenServer();
+
+        const std::string& path() const { return m_path; }
+        //accepts the clients until 'stop' is called from another thread
+        void serve();
+        //closes the listener and the connections, the requests in progress fail
+        void stop();
+    };
+
+    class CodegenClient
+    {
+    protected:
+        SocketHandle m_socket;
+    public:
+        explicit CodegenClient(const std::string &path);
+        CodegenClient(const CodegenClient&) = delete;
+        CodegenClient& operator=(const CodegenClient&) = delete;
+        ~CodegenClient();
+
+        //the text is passed to the sink as it comes, an error of the request is thrown as 'RemoteError'
+        void source(OutputSink &sink,
+            const std::vector<LongName> &include_names, const std::vector<LongName> &declare_names);
+        std::string source(const std::vector<LongName> &include_names, const std::vector<LongName> &declare_names)
+            { BufferSink sink; source(sink,include_names,declare_names); return sink.release(); }
+    };
+}
+#endif
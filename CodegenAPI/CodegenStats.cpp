@@ -0,0 +1,73 @@
+/*
+file:   CodegenStats.cpp
+
+author:	Aleksey Yakovlev
+data:	October 16, 2026
+
+Statistics of the code generation for a task on the topic of code generation.
+*/
+
+#include "pch.h"
+#include "CodegenStats.h"
+
+using namespace CodegenAPI;
+using namespace std;
+
+static void writeJsonString(OutputSink &sink, string_view text)
+{
+    static const char hex[] = "0123456789abcdef";
+    sink<<'"';
+    for(char ch : text)
+        if(ch=='"' || ch=='\\')sink<<'\\'<<ch;
+        else if(static_cast<unsigned char>(ch)<0x20)
+            sink<<"\\u00"<<hex[(ch>>4)&0xf]<<hex[ch&0xf];
+        else sink<<ch;
+    sink<<'"';
+}
+
+
+
+const char* CodegenStats::phaseName(Phase phase)
+{
+    static const char *names[PhaseCount] =
+        {"closure", "modules", "namespaces", "rendering", "translation", "verification", "interning"};
+    return names[size_t(phase)];
+}
+
+void CodegenStats::addIterations(string_view space, uint64_t count)
+{
+    if(space.empty())space = "::";
+    auto iterations_it = m_iterations.find(space);
+    if(iterations_it==m_iterations.end())m_iterations.emplace(string(space),count);
+    else iterations_it->second += count;
+}
+
+void CodegenStats::writeJson(OutputSink &sink) const
+{
+    sink<<"{\"phases\":{";
+    for(size_t i=0; i<PhaseCount; ++i)
+    {
+        if(i)sink<<',';
+        writeJsonString(sink,phaseName(Phase(i)));
+        sink<<":{\"calls\":"<<to_string(m_calls[i])<<",\"ns\":"<<to_string(m_times[i].count())<<'}';
+    }
+    sink<<"},\"counters\":{"
+        <<"\"lookups\":"<<to_string(m_counters.lookups)
+        <<",\"memo_hits\":"<<to_string(m_counters.memo_hits)
+        <<",\"closure_forwards\":"<<to_string(m_counters.closure_forwards)
+        <<",\"closure_modules\":"<<to_string(m_counters.closure_modules)
+        <<",\"namespaces_opened\":"<<to_string(m_counters.namespaces_opened)
+        <<",\"namespaces_closed\":"<<to_string(m_counters.namespaces_closed)
+        <<",\"peak_code_size\":"<<to_string(m_counters.peak_code_size)
+        <<"},\"iterations\":{";
+    bool first = true;
+    for(const auto & [space, count] : m_iterations)
+    {
+        if(!first)sink<<',';
+        first = false;
+        writeJsonString(sink,space);
+        sink<<':'<<to_string(count);
+    }
+    sink<<"}}";
+    sink.flush();
+}
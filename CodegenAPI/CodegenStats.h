@@ -0,0 +1,93 @@
+/*
+file:   CodegenStats.h
+
+author:	Aleksey Yakovlev
+data:	October 16, 2026
+
+Statistics of the code generation for a task on the topic of code generation.
+
+A 'CodegenStats' passed to 'Codegen::code', 'source', 'test' or to the 'translate'
+and 'verify' methods of 'IntermediateCode' accumulates the time of every phase,
+the name lookups, the memoized closures reused, the forwards and the modules of
+the dependency closure, the namespaces the topological schedule opens and closes
+and the peak size of the intermediate code. The text written by 'Codegen::source'
+is rendered without the intermediate code, so its time falls into the rendering
+phase. The methods take a null pointer by default, then the clock is never read
+and the counters are left in locals, so the disabled statistics cost nothing
+beyond a pointer test per phase.
+
+The statistics are not synchronized, a 'CodegenStats' serves one thread at a time.
+*/
+
+#ifndef CODEGEN_STATS_H
+#define CODEGEN_STATS_H
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <string_view>
+
+#include "OutputSink.h"
+
+namespace CodegenAPI
+{
+    class CodegenStats
+    {
+    public:
+        enum class Phase { Closure, Modules, Namespaces, Rendering, Translation, Verification, Interning };
+        static constexpr std::size_t PhaseCount = 7;
+        static const char* phaseName(Phase phase);
+
+        struct Counters
+        {
+            std::uint64_t lookups = 0;
+            std::uint64_t memo_hits = 0;
+            std::uint64_t closure_forwards = 0;
+            std::uint64_t closure_modules = 0;
+            std::uint64_t namespaces_opened = 0;
+            std::uint64_t namespaces_closed = 0;
+            std::uint64_t peak_code_size = 0;
+        };
+
+        //adds the time of its scope to the phase, a null statistics makes it empty
+        class Scope
+        {
+        protected:
+            CodegenStats *m_stats;
+            Phase m_phase;
+            std::chrono::steady_clock::time_point m_start;
+        public:
+            Scope(CodegenStats *stats, Phase phase) : m_stats(stats), m_phase(phase)
+                { if(m_stats)m_start = std::chrono::steady_clock::now(); }
+            Scope(const Scope&) = delete;
+            Scope& operator=(const Scope&) = delete;
+            ~Scope() { if(m_stats)m_stats->addTime(m_phase,std::chrono::steady_clock::now()-m_start); }
+        };
+    protected:
+        std::array<std::chrono::nanoseconds,PhaseCount> m_times {};
+        std::array<std::uint64_t,PhaseCount> m_calls {};
+        Counters m_counters;
+        std::map<std::string,std::uint64_t,std::less<>> m_iterations;
+    public:
+        void addTime(Phase phase, std::chrono::nanoseconds time)
+            { m_times[std::size_t(phase)] += time; ++m_calls[std::size_t(phase)]; }
+        //the global namespace is reported as "::"
+        void addIterations(std::string_view space, std::uint64_t count);
+        void notePeakCodeSize(std::size_t size)
+            { if(size>m_counters.peak_code_size)m_counters.peak_code_size = size; }
+        void clear() { *this = CodegenStats(); }
+
+        std::chrono::nanoseconds time(Phase phase) const { return m_times[std::size_t(phase)]; }
+        std::uint64_t calls(Phase phase) const { return m_calls[std::size_t(phase)]; }
+        Counters& counters() { return m_counters; }
+        const Counters& counters() const { return m_counters; }
+        const std::map<std::string,std::uint64_t,std::less<>>& iterations() const { return m_iterations; }
+
+        //one JSON object with the "phases", the "counters" and the "iterations" by namespaces
+        void writeJson(OutputSink &sink) const;
+        std::string json() const { BufferSink sink; writeJson(sink); return sink.release(); }
+    };
+}
+#endif
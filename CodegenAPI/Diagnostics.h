@@ -0,0 +1,85 @@
+/*
+file:   Diagnostics.h
+
+author:	Aleksey Yakovlev
+data:	October 16, 2026
+
+Diagnostics of the generation and the verification for a task on the topic of code generation.
+
+The generation and the verification report every problem they find to a 'Diagnostics'
+passed to them and go on, so one run lists all the problems of a request with the names
+they are about. Without the diagnostics the first problem is thrown at once by its error
+class of 'ErrorClasses.h', as the throwing methods of 'CodegenAPI::Codegen' and
+'CodegenAPI::IntermediateCode' do. A problem is listed once however many times it is met.
+*/
+
+#ifndef DIAGNOSTICS_H
+#define DIAGNOSTICS_H
+
+#include <exception>
+#include <set>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "ErrorClasses.h"
+
+namespace CodegenAPI
+{
+    enum class DiagnosticKind
+    {
+        NotFoundKey, NotFoundModule, NotFoundForward, DuplicateForward, NamespaceNesting, LoopForward, RejectedType,
+        MalformedKey
+    };
+
+    struct Diagnostic
+    {
+        DiagnosticKind kind;
+        //the key or the module the problem is about, the first member of a loop
+        std::string name;
+        //the message of the error the throwing methods raise for it
+        std::string message;
+        std::exception_ptr error;
+    };
+
+    class Diagnostics
+    {
+    protected:
+        std::vector<Diagnostic> m_entries;
+        std::set<std::pair<DiagnosticKind,std::string>> m_reported;
+    public:
+        void add(DiagnosticKind kind, std::string_view name, std::string message, std::exception_ptr error)
+        {
+            if(m_reported.emplace(kind,std::string(name)).second)
+                m_entries.push_back({kind,std::string(name),std::move(message),std::move(error)});
+        }
+        void append(const Diagnostics &other)
+            { for(const Diagnostic &entry : other.m_entries)add(entry.kind,entry.name,entry.message,entry.error); }
+
+        //the error is thrown at once without the diagnostics and is kept by them otherwise
+        template <class Error> static void report(Diagnostics *diagnostics,
+            DiagnosticKind kind, std::string_view name, Error error)
+        {
+            if(!diagnostics)throw error;
+            std::string message = error.what();
+            diagnostics->add(kind,name,std::move(message),std::make_exception_ptr(std::move(error)));
+        }
+        static void report(Diagnostics *diagnostics,
+            DiagnosticKind kind, std::string_view name, const std::exception_ptr &error, const std::string &message)
+        {
+            if(!diagnostics)std::rethrow_exception(error);
+            diagnostics->add(kind,name,message,error);
+        }
+
+        bool empty() const { return m_entries.empty(); }
+        std::size_t size() const { return m_entries.size(); }
+        const std::vector<Diagnostic>& entries() const { return m_entries; }
+        std::vector<Diagnostic>::const_iterator begin() const { return m_entries.begin(); }
+        std::vector<Diagnostic>::const_iterator end() const { return m_entries.end(); }
+
+        //throws the error of the first problem, as the throwing methods would have
+        void raise() const { if(!m_entries.empty())std::rethrow_exception(m_entries.front().error); }
+    };
+}
+#endif
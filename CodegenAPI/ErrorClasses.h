@@ -11,14 +11,23 @@ Description of error classes for a test on the topic of code generation.
 #define ERROR_CLASSES_H
 
 #include <stdexcept>
+#include <string>
+#include <vector>
 
 namespace CodegenAPI
 {
     class SyntaxError : public std::runtime_error
     {
+    protected:
+        std::size_t m_line = 0;
     public:
         SyntaxError() 
             : runtime_error("syntax error") { }
+        SyntaxError(std::size_t line, const std::string &reason) 
+            : runtime_error("syntax error at line "+std::to_string(line)+": "+reason), m_line(line) { }
+
+        //the line numbers start from one, zero stands for an unknown line
+        std::size_t line() const { return m_line; }
     };
 
     class NotFoundKeyError : public std::runtime_error
@@ -63,11 +72,60 @@ namespace CodegenAPI
            : runtime_error("not found forward error: "+key) { }
     };
 
+    class OutputError : public std::runtime_error
+    {
+    public:
+       OutputError(const std::string &name)
+           : runtime_error("output error: "+name) { }
+    };
+
+    class InputError : public std::runtime_error
+    {
+    public:
+       InputError(const std::string &name)
+           : runtime_error("input error: "+name) { }
+    };
+
+    class SnapshotError : public std::runtime_error
+    {
+    public:
+       SnapshotError(const std::string &reason)
+           : runtime_error("snapshot error: "+reason) { }
+    };
+
+    class SocketError : public std::runtime_error
+    {
+    public:
+       SocketError(const std::string &reason)
+           : runtime_error("socket error: "+reason) { }
+    };
+
+    //the error of a request reported by the generation server, with the message of the server
+    class RemoteError : public std::runtime_error
+    {
+    public:
+       RemoteError(const std::string &message)
+           : runtime_error("remote error: "+message) { }
+    };
+
     class LoopForwardError : public std::runtime_error
     {
+    protected:
+        std::vector<std::string> m_members;
+        static std::string describe(const std::vector<std::string> &members)
+        {
+            std::string loop;
+            for(const std::string &name : members)loop += name+" -> ";
+            return members.empty() ? loop : loop+members.front();
+        }
     public:
        LoopForwardError()  
            : runtime_error("loop forward error") { }
+       LoopForwardError(const std::vector<std::string> &members)  
+           : runtime_error("loop forward error: "+describe(members)), m_members(members) { }
+
+       //each member depends on the next one, the last depends on the first
+       const std::vector<std::string>& members() const { return m_members; }
     };
 }
 #endif
@@ -0,0 +1,64 @@
+/*
+file:   MappedFile.cpp
+
+author:	Aleksey Yakovlev
+data:	October 16, 2026
+
+Read-only memory mapping of a file for a task on the topic of code generation.
+*/
+
+#include "pch.h"
+#include "MappedFile.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace CodegenAPI;
+using namespace std;
+
+
+
+MappedFile::MappedFile(const string &path)
+{
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path.c_str(),GENERIC_READ,FILE_SHARE_READ,nullptr,
+        OPEN_EXISTING,FILE_ATTRIBUTE_NORMAL,nullptr);
+    if(file==INVALID_HANDLE_VALUE)throw InputError(path);
+    m_file = file;
+    LARGE_INTEGER size;
+    if(!GetFileSizeEx(file,&size)){ close(); throw InputError(path); }
+    m_size = static_cast<size_t>(size.QuadPart);
+    if(m_size==0)return;
+    m_mapping = CreateFileMappingA(file,nullptr,PAGE_READONLY,0,0,nullptr);
+    if(m_mapping)m_data = static_cast<const char*>(MapViewOfFile(m_mapping,FILE_MAP_READ,0,0,0));
+    if(!m_data){ close(); throw InputError(path); }
+#else
+    int fd = ::open(path.c_str(),O_RDONLY);
+    if(fd<0)throw InputError(path);
+    struct stat status;
+    if(fstat(fd,&status)!=0){ ::close(fd); throw InputError(path); }
+    m_size = static_cast<size_t>(status.st_size);
+    void *data = m_size>0 ? mmap(nullptr,m_size,PROT_READ,MAP_PRIVATE,fd,0) : nullptr;
+    ::close(fd);
+    if(data==MAP_FAILED)throw InputError(path);
+    m_data = static_cast<const char*>(data);
+#endif
+}
+
+void MappedFile::close()
+{
+#ifdef _WIN32
+    if(m_data)UnmapViewOfFile(m_data);
+    if(m_mapping)CloseHandle(m_mapping);
+    if(m_file)CloseHandle(m_file);
+#else
+    if(m_data)munmap(const_cast<char*>(m_data),m_size);
+#endif
+    m_data = nullptr; m_mapping = nullptr; m_file = nullptr;
+}
@@ -0,0 +1,43 @@
+/*
+file:   MappedFile.h
+
+author:	Aleksey Yakovlev
+data:	October 16, 2026
+
+Read-only memory mapping of a file for a task on the topic of code generation.
+
+The file is mapped as a whole and stays mapped for the lifetime of the object,
+an empty file is represented by an empty view without a mapping.
+*/
+
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <string>
+#include <string_view>
+
+#include "ErrorClasses.h"
+
+namespace CodegenAPI
+{
+    class MappedFile
+    {
+    protected:
+        const char *m_data = nullptr;
+        std::size_t m_size = 0;
+        void *m_file = nullptr;
+        void *m_mapping = nullptr;
+
+        void close();
+    public:
+        explicit MappedFile(const std::string &path);
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+        ~MappedFile() { close(); }
+
+        const char* data() const { return m_data; }
+        std::size_t size() const { return m_size; }
+        std::string_view view() const { return std::string_view(m_data,m_size); }
+    };
+}
+#endif
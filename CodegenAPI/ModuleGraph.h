@@ -0,0 +1,42 @@
+/*
+file:   ModuleGraph.h
+
+author:	Aleksey Yakovlev
+data:	October 16, 2026
+
+Module include graph of a scheme for a task on the topic of code generation.
+
+The graph tells which modules include which, as "my_library.h" includes <string>.
+A 'CodegenAPI::Codegen' given the graph emits only the modules which are not
+included by another emitted module, so a header does not repeat the includes
+of the headers it includes. The modules including each other in a loop cover
+each other, then the first of them in the include order is emitted.
+The verification accepts a module covered by an included one.
+*/
+
+#ifndef MODULE_GRAPH_H
+#define MODULE_GRAPH_H
+
+#include <map>
+#include <set>
+
+#include "TypeInfo.h"
+
+namespace CodegenAPI
+{
+    class ModuleGraph
+    {
+    protected:
+        std::map<ModuleName,std::set<ModuleName>> m_includes;
+    public:
+        //the modules without a name are ignored
+        void addInclude(const ModuleName &module, const ModuleName &included)
+        {
+            if(module.isPerfect() && included.isPerfect())m_includes[module].insert(included);
+        }
+
+        bool empty() const { return m_includes.empty(); }
+        const std::map<ModuleName,std::set<ModuleName>>& entries() const { return m_includes; }
+    };
+}
+#endif
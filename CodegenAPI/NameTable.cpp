@@ -0,0 +1,100 @@
+/*
+file:   NameTable.cpp
+
+author:	Aleksey Yakovlev
+data:	October 16, 2026
+
+Interning table of qualified names for a task on the topic of code generation.
+*/
+
+#include "pch.h"
+#include "NameTable.h"
+
+#include <algorithm>
+#include <cstring>
+
+using namespace CodegenAPI;
+using namespace std;
+
+
+
+uint32_t NameTable::hash(string_view name)
+{
+    uint32_t value = 2166136261u; //FNV-1a
+    for(char ch : name){ value ^= static_cast<unsigned char>(ch); value *= 16777619u; }
+    return value;
+}
+
+void NameTable::rehash(size_t capacity)
+{
+    vector<Slot> slots(capacity,Slot{0,NoName});
+    for(const Slot *slot = this->slots(), *last = slot+this->capacity(); slot!=last; ++slot)if(slot->id!=NoName)
+    {
+        size_t i = slot->hash&(capacity-1);
+        while(slots[i].id!=NoName)i = (i+1)&(capacity-1);
+        slots[i] = *slot;
+    }
+    m_slots.swap(slots);
+}
+
+void NameTable::reserve(size_t count)
+{
+    size_t capacity = 16; while(capacity<2*count)capacity *= 2;
+    if(capacity>this->capacity())rehash(capacity);
+}
+
+string_view NameTable::copy(string_view name)
+{
+    if(name.empty())return string_view();
+    if(name.size()>m_pool.left)
+    {
+        //a long name takes a chunk of its own size
+        size_t size = max(name.size(),ChunkSize);
+        shared_ptr<char[]> chunk(new char[size]);
+        m_pool.free = chunk.get(); m_pool.left = size;
+        m_owners.push_back(move(chunk));
+    }
+    char *first = m_pool.free;
+    memcpy(first,name.data(),name.size());
+    m_pool.free += name.size(); m_pool.left -= name.size();
+    return string_view(first,name.size());
+}
+
+NameId NameTable::intern(string_view name)
+{
+    uint32_t value = hash(name);
+    if(NameId id = find(name,value); id!=NoName)return id;
+    return insert(copy(name),value);
+}
+
+NameId NameTable::borrow(string_view name)
+{
+    uint32_t value = hash(name);
+    if(NameId id = find(name,value); id!=NoName)return id;
+    return insert(name,value);
+}
+
+NameId NameTable::insert(string_view name, uint32_t value)
+{
+    if(2*(size()+1)>capacity())reserve(size()+1);
+    else if(m_slots.empty())m_slots.assign(m_base_slots,m_base_slots+m_base_capacity);
+
+    NameId id = static_cast<NameId>(size());
+    m_names.push_back(name);
+    size_t i = value&(m_slots.size()-1);
+    while(m_slots[i].id!=NoName)i = (i+1)&(m_slots.size()-1);
+    m_slots[i] = {value,id};
+    return id;
+}
+
+NameId NameTable::find(string_view name) const
+    { return find(name,hash(name)); }
+
+NameId NameTable::find(string_view name, uint32_t hash) const
+{
+    const Slot *slots = this->slots(); size_t mask = capacity()-1;
+    if(!slots)return NoName;
+    for(size_t i = hash&mask; slots[i].id!=NoName; i = (i+1)&mask)
+        if(slots[i].hash==hash && view(slots[i].id)==name)return slots[i].id;
+    return NoName;
+}
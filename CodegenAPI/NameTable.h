@@ -0,0 +1,120 @@
+/*
+file:   NameTable.h
+
+author:	Aleksey Yakovlev
+data:	October 16, 2026
+
+Interning table of qualified names for a task on the topic of code generation.
+
+Each distinct name is stored once and is referred to by a compact 'NameId'.
+Identifiers are stable for the lifetime of the table and copies of the table
+keep all previously issued identifiers.
+
+The names are indexed by an open addressing hash table with linear probing.
+The slots are kept in one contiguous array together with the precomputed hashes,
+so a lookup is a single probe sequence which compares the strings only
+when the hashes are equal.
+
+A table can start from a read-only base, as the names of a mapped snapshot.
+The base names and slots are used in place, the slots are copied only when
+a name missing from the base is interned.
+
+The interned names are copied into the chunks of the table, which its copies
+share. A name kept elsewhere, as by a 'SchemeArena', is borrowed in place when
+the table keeps its owner, so every name is stored once.
+*/
+
+#ifndef NAME_TABLE_H
+#define NAME_TABLE_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace CodegenAPI
+{
+    using NameId = std::uint32_t;
+
+    constexpr NameId NoName = ~NameId(0);
+
+    //a read-only view of a contiguous range, as the identifiers of the dependencies
+    template <class T> class Span
+    {
+    protected:
+        const T *m_first;
+        const T *m_last;
+    public:
+        Span(const T *first = nullptr, const T *last = nullptr) : m_first(first), m_last(last) { }
+
+        const T* begin() const { return m_first; }
+        const T* end() const { return m_last; }
+        std::size_t size() const { return static_cast<std::size_t>(m_last-m_first); }
+        bool empty() const { return m_first==m_last; }
+        const T& operator[](std::size_t i) const { return m_first[i]; }
+    };
+
+    class NameTable
+    {
+        friend class Snapshot;
+    public:
+        struct Slot { std::uint32_t hash; NameId id; };
+    protected:
+        std::shared_ptr<const void> m_base;
+        const char *m_base_chars = nullptr;
+        const std::uint32_t *m_base_offsets = nullptr;
+        const Slot *m_base_slots = nullptr;
+        std::size_t m_base_capacity = 0;
+        NameId m_base_count = 0;
+
+        //a copy of the table shares the filled chunks and starts a chunk of its own
+        struct Pool
+        {
+            char *free = nullptr;
+            std::size_t left = 0;
+
+            Pool() = default;
+            Pool(const Pool&) { }
+            Pool& operator=(const Pool&) { free = nullptr; left = 0; return *this; }
+        };
+        static constexpr std::size_t ChunkSize = 1<<14;
+
+        std::vector<std::string_view> m_names;
+        std::vector<std::shared_ptr<const void>> m_owners;
+        Pool m_pool;
+        std::vector<Slot> m_slots;
+
+        const Slot* slots() const { return m_slots.empty() ? m_base_slots : m_slots.data(); }
+        std::size_t capacity() const { return m_slots.empty() ? m_base_capacity : m_slots.size(); }
+        void rehash(std::size_t capacity);
+        std::string_view copy(std::string_view name);
+        NameId insert(std::string_view name, std::uint32_t hash);
+    public:
+        NameTable() = default;
+        //the base keeps the names 'chars[offsets[id]..offsets[id+1])' and a power of two count of slots
+        NameTable(std::shared_ptr<const void> base, const char *chars, const std::uint32_t *offsets,
+            NameId count, const Slot *slots, std::size_t capacity)
+            : m_base(std::move(base)), m_base_chars(chars), m_base_offsets(offsets),
+            m_base_slots(slots), m_base_capacity(capacity), m_base_count(count) { }
+
+        static std::uint32_t hash(std::string_view name);
+
+        NameId intern(std::string_view name);
+        //the name is referred to in place, its owner is kept by 'keep' or outlives the table
+        NameId borrow(std::string_view name);
+        //the owner of the borrowed names lives as long as the table and its copies
+        void keep(std::shared_ptr<const void> owner) { m_owners.push_back(std::move(owner)); }
+        NameId find(std::string_view name) const;
+        NameId find(std::string_view name, std::uint32_t hash) const;
+        void reserve(std::size_t count);
+
+        std::string_view view(NameId id) const
+        {
+            if(id>=m_base_count)return m_names[id-m_base_count];
+            return std::string_view(m_base_chars+m_base_offsets[id],m_base_offsets[id+1]-m_base_offsets[id]);
+        }
+        std::size_t size() const { return m_base_count+m_names.size(); }
+    };
+}
+#endif
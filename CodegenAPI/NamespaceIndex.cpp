@@ -0,0 +1,84 @@
+/*
+file:   NamespaceIndex.cpp
+
+author:	Aleksey Yakovlev
+data:	October 16, 2026
+
+Namespace index of a scheme for a task on the topic of code generation.
+*/
+
+#include "pch.h"
+#include "NamespaceIndex.h"
+#include "CodegenAPI.h"
+
+#include <string_view>
+
+using namespace CodegenAPI;
+using namespace std;
+
+
+
+NamespaceIndex::NamespaceIndex(const InternedScheme &scheme)
+    : m_type_nodes(scheme.size(),NoNode), m_type_ranks(scheme.size())
+{
+    //the tree is drafted by the names, then laid out in the breadth first order;
+    //the types of a snapshot are told by their entries and are not decoded
+    struct Draft
+    {
+        NameId space;
+        map<string_view,NodeId> children;
+        map<string_view,NameId> types;
+    };
+    vector<Draft> drafts(1,Draft{NoName,{},{}});
+    for(NameId id = 0; id<scheme.size(); ++id)if(scheme.hasInfo(id))
+    {
+        string_view name = scheme.view(id);
+        NodeId draft = Root;
+        size_t offset = 0, pos;
+        bool valid = true;
+        while(valid && (pos = name.find(':',offset))!=string_view::npos)
+        {
+            //an empty segment is a namespace without a name, as the leading one of '::a'
+            if(pos+1==name.size() || name[pos+1]!=':'){ valid = false; break; }
+            auto [child_it, added] = drafts[draft].children.try_emplace(name.substr(offset,pos-offset),
+                static_cast<NodeId>(drafts.size()));
+            NodeId child = child_it->second;
+            if(added)drafts.push_back(Draft{scheme.find(name.substr(0,pos)),{},{}});
+            draft = child; offset = pos+2;
+        }
+        if(valid && offset<name.size())drafts[draft].types.emplace(name.substr(offset),id);
+    }
+
+    vector<NodeId> order{Root};
+    m_nodes.reserve(drafts.size()); m_nodes.push_back(Node{NoName,NoNode,0,0,0,0});
+    for(NodeId id = 0; id<order.size(); ++id)
+    {
+        const Draft &draft = drafts[order[id]];
+        m_nodes[id].first_child = static_cast<NodeId>(m_nodes.size());
+        m_nodes[id].child_count = static_cast<uint32_t>(draft.children.size());
+        for(const auto & [segment, child] : draft.children)
+        {
+            order.push_back(child);
+            m_nodes.push_back(Node{drafts[child].space,id,0,0,0,0});
+        }
+
+        m_nodes[id].first_type = static_cast<uint32_t>(m_types.size());
+        m_nodes[id].type_count = static_cast<uint32_t>(draft.types.size());
+        for(const auto & [relative, keyname] : draft.types)
+        {
+            m_type_nodes[keyname] = id;
+            m_type_ranks[keyname] = static_cast<uint32_t>(m_types.size()-m_nodes[id].first_type);
+            m_types.push_back(keyname);
+        }
+    }
+
+    m_preorder.resize(m_nodes.size());
+    vector<NodeId> stack{Root};
+    for(uint32_t position = 0; !stack.empty(); ++position)
+    {
+        NodeId id = stack.back(); stack.pop_back();
+        m_preorder[id] = position;
+        for(NodeId child = m_nodes[id].first_child+m_nodes[id].child_count; child>m_nodes[id].first_child;)
+            stack.push_back(--child);
+    }
+}
@@ -0,0 +1,73 @@
+/*
+file:   NamespaceIndex.h
+
+author:	Aleksey Yakovlev
+data:	October 16, 2026
+
+Namespace index of a scheme for a task on the topic of code generation.
+
+The index is the tree of the namespaces of all types of a scheme built once
+for the scheme. The nodes are kept in one array in the breadth first order,
+so the children of a namespace are contiguous and ordered by their names,
+and the types of every namespace are kept in one array ordered by their names
+relative to the namespace. A type knows its namespace and its rank there.
+The generation marks only the nodes it reaches and never splits the names.
+
+The levels of the nested namespaces stay separate nodes, as every level is
+opened by the generated code on its own.
+*/
+
+#ifndef NAMESPACE_INDEX_H
+#define NAMESPACE_INDEX_H
+
+#include <cstdint>
+#include <vector>
+
+#include "NameTable.h"
+
+namespace CodegenAPI
+{
+    class InternedScheme;
+
+    class NamespaceIndex
+    {
+    public:
+        using NodeId = std::uint32_t;
+        static constexpr NodeId NoNode = ~NodeId(0);
+        static constexpr NodeId Root = 0;
+
+        struct Node
+        {
+            NameId space;
+            NodeId parent;
+            NodeId first_child;
+            std::uint32_t child_count;
+            std::uint32_t first_type;
+            std::uint32_t type_count;
+        };
+    protected:
+        std::vector<Node> m_nodes;
+        std::vector<NameId> m_types;
+        std::vector<NodeId> m_type_nodes;
+        std::vector<std::uint32_t> m_type_ranks;
+        std::vector<std::uint32_t> m_preorder;
+    public:
+        //the types with malformed names are left out of the index
+        explicit NamespaceIndex(const InternedScheme &scheme);
+
+        std::size_t size() const { return m_nodes.size(); }
+        const Node& node(NodeId id) const { return m_nodes[id]; }
+        Span<NameId> types(NodeId id) const
+        {
+            const NameId *first = m_types.data()+m_nodes[id].first_type;
+            return Span<NameId>(first,first+m_nodes[id].type_count);
+        }
+
+        NodeId nodeOf(NameId keyname) const
+            { return keyname<m_type_nodes.size() ? m_type_nodes[keyname] : NoNode; }
+        std::uint32_t rankOf(NameId keyname) const { return m_type_ranks[keyname]; }
+        //the position of the node in the depth first order, a subtree takes a contiguous range
+        std::uint32_t preorder(NodeId id) const { return m_preorder[id]; }
+    };
+}
+#endif
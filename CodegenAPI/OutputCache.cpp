@@ -0,0 +1,137 @@
+/*
+file:   OutputCache.cpp
+
+author:	Aleksey Yakovlev
+data:	October 16, 2026
+
+Persistent cache of the generated text for a task on the topic of code generation.
+*/
+
+#include "pch.h"
+#include "OutputCache.h"
+#include "MappedFile.h"
+#include "OutputSink.h"
+
+#include <atomic>
+#include <cstring>
+#include <filesystem>
+#include <system_error>
+#ifdef _WIN32
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
+
+using namespace CodegenAPI;
+using namespace std;
+
+
+
+static uint64_t finalize(uint64_t word)
+{
+    word ^= word>>33; word *= 0xff51afd7ed558ccd;
+    word ^= word>>33; word *= 0xc4ceb9fe1a85ec53;
+    return word^(word>>33);
+}
+
+void Fingerprint::mix(uint64_t word)
+{
+    m_first = (m_first^finalize(word))*0x9e3779b97f4a7c15;
+    m_first ^= m_first>>29;
+    m_second = (m_second+word)*0xbf58476d1ce4e5b9;
+    m_second = (m_second<<31|m_second>>33)^m_first;
+}
+
+Fingerprint& Fingerprint::add(string_view field)
+{
+    mix(field.size());
+    size_t pos = 0;
+    for(; pos+8<=field.size(); pos += 8)
+    {
+        uint64_t word = 0;
+        for(size_t i=0; i<8; ++i)word |= uint64_t(static_cast<unsigned char>(field[pos+i]))<<(8*i);
+        mix(word);
+    }
+    if(pos<field.size())
+    {
+        uint64_t word = 0;
+        for(size_t i=0; pos+i<field.size(); ++i)word |= uint64_t(static_cast<unsigned char>(field[pos+i]))<<(8*i);
+        mix(word);
+    }
+    m_size += field.size()+1;
+    return *this;
+}
+
+Fingerprint& Fingerprint::add(uint64_t field)
+{
+    mix(field); ++m_size; return *this;
+}
+
+string Fingerprint::hex() const
+{
+    static const char digits[] = "0123456789abcdef";
+    uint64_t words[2] = {finalize(m_first^m_size),finalize(m_second+m_first)};
+    string text;
+    for(uint64_t word : words)
+        for(int shift = 60; shift>=0; shift -= 4)text.push_back(digits[(word>>shift)&0xf]);
+    return text;
+}
+
+
+
+OutputCache::OutputCache(string directory) : m_directory(move(directory))
+{
+    error_code error;
+    filesystem::create_directories(m_directory,error);
+    if(!filesystem::is_directory(m_directory))throw OutputError(m_directory);
+}
+
+string OutputCache::entryPath(const string &key) const
+{
+    if(key.size()<3 || key.find_first_of("/\\.")!=string::npos)throw OutputError("cache key "+key);
+    return (filesystem::path(m_directory)/key.substr(0,2)/key.substr(2)).string();
+}
+
+bool OutputCache::find(const string &key, string &text) const
+{
+    string path = entryPath(key);
+    try { MappedFile file(path); text.assign(file.view()); return true; }
+    catch(const InputError&) { return false; }
+}
+
+void OutputCache::store(const string &key, string_view text) const
+{
+    string path = entryPath(key);
+    error_code error;
+    filesystem::create_directories(filesystem::path(path).parent_path(),error);
+    replace(path,text);
+}
+
+bool OutputCache::replace(const string &path, string_view text)
+{
+    try { MappedFile file(path); if(file.view()==text)return false; }
+    catch(const InputError&) { }
+
+    //the temporary name is unique over the processes and the threads writing the same file
+    static atomic<uint64_t> counter{0};
+#ifdef _WIN32
+    uint64_t process = static_cast<uint64_t>(_getpid());
+#else
+    uint64_t process = static_cast<uint64_t>(getpid());
+#endif
+    string temporary = path+".tmp"+to_string(process)+"."+to_string(counter++);
+    try
+    {
+        FileSink sink(temporary);
+        sink<<text;
+        sink.close();
+        filesystem::rename(temporary,path);
+    }
+    catch(...)
+    {
+        error_code error;
+        filesystem::remove(temporary,error);
+        throw OutputError(path);
+    }
+    return true;
+}
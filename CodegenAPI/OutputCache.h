@@ -0,0 +1,70 @@
+/*
+file:   OutputCache.h
+
+author:	Aleksey Yakovlev
+data:	October 16, 2026
+
+Persistent cache of the generated text for a task on the topic of code generation.
+
+The text of a request is kept in a directory under the fingerprint of everything
+it is generated from: the request itself, the types of its dependency closure with
+the modules they need and the module graph over these modules, as 'Codegen::fingerprint'
+computes it. An edit of the scheme outside the closure leaves the fingerprint and
+the cached text as they are. The entries are named by the hex digits of the fingerprint
+and split into the subdirectories by the first two of them.
+
+Every file is written into a temporary file beside it and renamed over the former one,
+so a reader sees either the former or the complete new text. An output file is written
+only when its text changes, so its time stays as it was for the build tools.
+*/
+
+#ifndef OUTPUT_CACHE_H
+#define OUTPUT_CACHE_H
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include "ErrorClasses.h"
+
+namespace CodegenAPI
+{
+    //a 128-bit hash of a sequence of fields, every field is hashed with its length,
+    //so the fields are never confused with their concatenation
+    class Fingerprint
+    {
+    protected:
+        std::uint64_t m_first;
+        std::uint64_t m_second;
+        std::uint64_t m_size;
+
+        void mix(std::uint64_t word);
+    public:
+        Fingerprint() : m_first(0x243f6a8885a308d3), m_second(0x13198a2e03707344), m_size(0) { }
+
+        Fingerprint& add(std::string_view field);
+        Fingerprint& add(std::uint64_t field);
+        //32 lowercase hex digits
+        std::string hex() const;
+    };
+
+    class OutputCache
+    {
+    protected:
+        std::string m_directory;
+
+        std::string entryPath(const std::string &key) const;
+    public:
+        //the directory is created when it is missing
+        explicit OutputCache(std::string directory);
+
+        const std::string& directory() const { return m_directory; }
+        //false when there is no entry of the key
+        bool find(const std::string &key, std::string &text) const;
+        void store(const std::string &key, std::string_view text) const;
+
+        //writes the file atomically, returns false and leaves the file untouched when it has the text
+        static bool replace(const std::string &path, std::string_view text);
+    };
+}
+#endif
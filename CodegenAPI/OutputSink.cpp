@@ -0,0 +1,74 @@
+/*
+file:   OutputSink.cpp
+
+author:	Aleksey Yakovlev
+data:	October 16, 2026
+
+Output sinks for the translation of the intermediate code for a task
+on the topic of code generation.
+*/
+
+#include "pch.h"
+#include "OutputSink.h"
+
+#include <cerrno>
+#include <fcntl.h>
+#ifdef _WIN32
+#include <io.h>
+#include <sys/stat.h>
+#else
+#include <unistd.h>
+#endif
+
+using namespace CodegenAPI;
+using namespace std;
+
+
+
+FileSink::FileSink(const string &path, size_t chunk) : OutputSink(chunk), m_own(true)
+{
+#ifdef _WIN32
+    m_fd = _open(path.c_str(),_O_WRONLY|_O_CREAT|_O_TRUNC|_O_BINARY,_S_IREAD|_S_IWRITE);
+#else
+    m_fd = ::open(path.c_str(),O_WRONLY|O_CREAT|O_TRUNC,0644);
+#endif
+    if(m_fd<0)throw OutputError(path);
+}
+
+FileSink::~FileSink()
+{
+    try { close(); } catch(...) { }
+}
+
+void FileSink::drain()
+{
+    for(size_t done=0; done<m_buffer.size();)
+    {
+#ifdef _WIN32
+        int count = _write(m_fd,m_buffer.data()+done,static_cast<unsigned>(m_buffer.size()-done));
+#else
+        ssize_t count = ::write(m_fd,m_buffer.data()+done,m_buffer.size()-done);
+        if(count<0 && errno==EINTR)continue;
+#endif
+        if(count<=0)throw OutputError("file descriptor "+to_string(m_fd));
+        done += static_cast<size_t>(count);
+    }
+    m_buffer.clear();
+}
+
+void FileSink::close()
+{
+    if(m_fd<0)return;
+    drain();
+    if(m_own)
+    {
+#ifdef _WIN32
+        int result = _close(m_fd);
+#else
+        int result = ::close(m_fd);
+#endif
+        m_fd = -1;
+        if(result!=0)throw OutputError("file close");
+    }
+    else m_fd = -1;
+}
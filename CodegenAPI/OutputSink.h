@@ -0,0 +1,88 @@
+/*
+file:   OutputSink.h
+
+author:	Aleksey Yakovlev
+data:	October 16, 2026
+
+Output sinks for the translation of the intermediate code for a task
+on the topic of code generation.
+
+A sink collects the text in its own growable buffer. The 'BufferSink' keeps
+the whole text and can be reused for the next translation without reallocation.
+The 'StreamSink' and the 'FileSink' pass the buffer to a 'std::ostream' or to
+a file descriptor every time it reaches the chunk size, so the complete text
+is never held in memory.
+*/
+
+#ifndef OUTPUT_SINK_H
+#define OUTPUT_SINK_H
+
+#include <string>
+#include <string_view>
+#include <ostream>
+
+#include "ErrorClasses.h"
+
+namespace CodegenAPI
+{
+    class OutputSink
+    {
+    protected:
+        std::string m_buffer;
+        std::size_t m_chunk;
+
+        virtual void drain() { }
+    public:
+        explicit OutputSink(std::size_t chunk = 1<<16) : m_chunk(chunk) { }
+        OutputSink(const OutputSink&) = delete;
+        OutputSink& operator=(const OutputSink&) = delete;
+        virtual ~OutputSink() = default;
+
+        void write(const char *data, std::size_t size)
+            { m_buffer.append(data,size); if(m_buffer.size()>=m_chunk)drain(); }
+        OutputSink& fill(char ch, std::size_t count)
+            { m_buffer.append(count,ch); if(m_buffer.size()>=m_chunk)drain(); return *this; }
+        void flush() { drain(); }
+
+        OutputSink& operator<<(std::string_view text) { write(text.data(),text.size()); return *this; }
+        OutputSink& operator<<(char ch) { return fill(ch,1); }
+    };
+
+    class BufferSink : public OutputSink
+    {
+    public:
+        BufferSink() : OutputSink(std::string::npos) { }
+
+        std::string_view view() const { return m_buffer; }
+        std::string release() { std::string text; text.swap(m_buffer); return text; }
+        void clear() { m_buffer.clear(); }
+    };
+
+    class StreamSink : public OutputSink
+    {
+    protected:
+        std::ostream &m_stream;
+        void drain() override { m_stream.write(m_buffer.data(),m_buffer.size()); m_buffer.clear(); }
+    public:
+        explicit StreamSink(std::ostream &stream, std::size_t chunk = 1<<16)
+            : OutputSink(chunk), m_stream(stream) { }
+        ~StreamSink() override { drain(); }
+    };
+
+    class FileSink : public OutputSink
+    {
+    protected:
+        int m_fd;
+        bool m_own;
+        void drain() override;
+    public:
+        explicit FileSink(int fd, std::size_t chunk = 1<<16)
+            : OutputSink(chunk), m_fd(fd), m_own(false) { }
+        explicit FileSink(const std::string &path, std::size_t chunk = 1<<16);
+        ~FileSink() override;
+
+        //reports the write errors the destructor has to ignore
+        void close();
+    };
+}
+#endif
@@ -0,0 +1,31 @@
+/*
+file:   SchemeArena.cpp
+
+author:	Aleksey Yakovlev
+data:	October 16, 2026
+
+Monotonic arena storage of the meta information for a task on the topic
+of code generation.
+*/
+
+#include "pch.h"
+#include "SchemeArena.h"
+
+using namespace CodegenAPI;
+using namespace std;
+
+
+
+SchemeArena::~SchemeArena()
+{
+    for(auto info_it = m_objects.rbegin(); info_it!=m_objects.rend(); ++info_it)
+        (*info_it)->~TypeInfo();
+}
+
+const LongName& SchemeArena::intern(string_view text)
+{
+    if(auto name_it = m_name_index.find(text); name_it!=m_name_index.end())return *name_it->second;
+    const LongName &name = m_names.emplace_back(text);
+    m_name_index.emplace(name,&name);
+    return name;
+}
@@ -0,0 +1,77 @@
+/*
+file:   SchemeArena.h
+
+author:	Aleksey Yakovlev
+data:	October 16, 2026
+
+Monotonic arena storage of the meta information for a task on the topic
+of code generation.
+
+The arena owns the type descriptions created by the 'make' factories together
+with their parameter and template parameter lists and the keys added to it.
+A name is kept once however many keys and parameters refer to it; the list of the
+kept names and their index take their memory from the arena as well.
+The memory is released at once with the arena, which is shared with
+'CodegenAPI::Codegen' objects constructed from it.
+*/
+
+#ifndef SCHEME_ARENA_H
+#define SCHEME_ARENA_H
+
+#include <deque>
+#include <memory_resource>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+#include "TypeInfo.h"
+
+namespace CodegenAPI
+{
+    class SchemeArena
+    {
+    protected:
+        std::pmr::monotonic_buffer_resource m_resource;
+        std::vector<TypeInfo*> m_objects;
+        std::vector<std::pair<std::string_view,TypeInfo*>> m_entries;
+        //a kept name is a 'LongName' for the parameters referring to it, so a name longer
+        //than the inline buffer of a string has its characters on the heap
+        std::pmr::deque<LongName> m_names;
+        std::pmr::unordered_map<std::string_view,const LongName*> m_name_index;
+    public:
+        using allocator_type = TypeInfo::allocator_type;
+
+        explicit SchemeArena(std::size_t initial_size = 1<<16)
+            : m_resource(initial_size), m_names(&m_resource), m_name_index(&m_resource) { }
+        SchemeArena(const SchemeArena&) = delete;
+        SchemeArena& operator=(const SchemeArena&) = delete;
+        ~SchemeArena();
+
+        allocator_type allocator() { return allocator_type(&m_resource); }
+        void reserve(std::size_t count) { m_objects.reserve(count); m_entries.reserve(count); }
+
+        template <class Info, class... Args> Info* make(Args&&... args)
+        {
+            Info *info = static_cast<Info*>(m_resource.allocate(sizeof(Info),alignof(Info)));
+            if constexpr(std::is_constructible_v<Info,Args&&...,const allocator_type&>)
+                new(info) Info(std::forward<Args>(args)...,allocator());
+            else new(info) Info(std::forward<Args>(args)...);
+            m_objects.push_back(info);
+            return info;
+        }
+
+        //the kept name stays in place as long as the arena
+        const LongName& intern(std::string_view text);
+        //the kept name or null when the arena does not keep it
+        const LongName* kept(std::string_view text) const
+        {
+            auto name_it = m_name_index.find(text);
+            return name_it!=m_name_index.end() ? name_it->second : nullptr;
+        }
+        void add(std::string_view keyname, TypeInfo *info) { m_entries.push_back({intern(keyname),info}); }
+
+        const std::vector<std::pair<std::string_view,TypeInfo*>>& entries() const { return m_entries; }
+    };
+}
+#endif
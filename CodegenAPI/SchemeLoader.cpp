@@ -0,0 +1,184 @@
+/*
+file:   SchemeLoader.cpp
+
+author:	Aleksey Yakovlev
+data:	October 16, 2026
+
+Loader of the text scheme definitions for a task on the topic of code generation.
+*/
+
+#include "pch.h"
+#include "SchemeLoader.h"
+#include "MappedFile.h"
+
+using namespace CodegenAPI;
+using namespace std;
+
+
+
+//the classes of the characters are looked up in one table
+enum CharClass : unsigned char { SpaceChar = 1, WordChar = 2, ScopeChar = 4 };
+
+static const struct CharClasses
+{
+    unsigned char table[256] = {};
+    CharClasses()
+    {
+        table[static_cast<unsigned char>(' ')] = table[static_cast<unsigned char>('\t')] = 
+            table[static_cast<unsigned char>('\r')] = SpaceChar;
+        for(char ch='a'; ch<='z'; ++ch)table[static_cast<unsigned char>(ch)] = WordChar;
+        for(char ch='A'; ch<='Z'; ++ch)table[static_cast<unsigned char>(ch)] = WordChar;
+        for(char ch='0'; ch<='9'; ++ch)table[static_cast<unsigned char>(ch)] = WordChar;
+        table[static_cast<unsigned char>('_')] = WordChar;
+        table[static_cast<unsigned char>(':')] = ScopeChar;
+    }
+    unsigned char operator[](char ch) const { return table[static_cast<unsigned char>(ch)]; }
+} charClasses;
+
+static bool isSpace(char ch) { return charClasses[ch]==SpaceChar; }
+static bool isWordChar(char ch) { return charClasses[ch]==WordChar; }
+
+static string_view trim(string_view text)
+{
+    while(!text.empty() && isSpace(text.front()))text.remove_prefix(1);
+    while(!text.empty() && isSpace(text.back()))text.remove_suffix(1);
+    return text;
+}
+
+//takes the next token separated by the spaces from the text
+static string_view nextToken(string_view &text)
+{
+    text = trim(text);
+    size_t end = 0; while(end<text.size() && !isSpace(text[end]))++end;
+    string_view token = text.substr(0,end); text.remove_prefix(end);
+    return token;
+}
+
+//the qualified names consist of words and '::', the parameter types may have inner spaces
+static bool isTypeName(string_view name, bool spaces)
+{
+    unsigned char allowed = WordChar|ScopeChar|(spaces ? SpaceChar : 0);
+    if(name.empty())return false;
+    for(char ch : name)if(!(charClasses[ch]&allowed))return false;
+    return true;
+}
+
+static bool isWord(string_view name)
+    { return !name.empty() && all_of(begin(name),end(name),isWordChar); }
+
+
+
+void SchemeLoader::feed(string_view chunk)
+{
+    if(!m_partial.empty())
+    {
+        size_t end = chunk.find('\n');
+        if(end==string_view::npos){ m_partial.append(chunk); return; }
+        m_partial.append(chunk.substr(0,end)); chunk.remove_prefix(end+1);
+        parseLine(m_partial); m_partial.clear();
+    }
+    for(size_t end; (end = chunk.find('\n'))!=string_view::npos; chunk.remove_prefix(end+1))
+        parseLine(chunk.substr(0,end));
+    m_partial.assign(chunk);
+}
+
+shared_ptr<SchemeArena> SchemeLoader::finish()
+{
+    if(!m_partial.empty()){ parseLine(m_partial); m_partial.clear(); }
+    return m_arena;
+}
+
+shared_ptr<SchemeArena> SchemeLoader::parse(string_view text)
+{
+    //a whole text is counted first, so the arena keeps its lists without regrowth
+    SchemeLoader loader;
+    loader.m_arena->reserve(static_cast<size_t>(count(begin(text),end(text),'\n'))+1);
+    loader.feed(text); return loader.finish();
+}
+
+shared_ptr<SchemeArena> SchemeLoader::load(const string &path)
+{
+    MappedFile file(path);
+    return parse(file.view());
+}
+
+shared_ptr<SchemeArena> SchemeLoader::read(istream &stream, size_t chunk)
+{
+    SchemeLoader loader;
+    vector<char> buffer(chunk);
+    while(stream.read(buffer.data(),buffer.size()) || stream.gcount()>0)
+        loader.feed(string_view(buffer.data(),static_cast<size_t>(stream.gcount())));
+    if(stream.bad())throw InputError("stream");
+    return loader.finish();
+}
+
+
+
+void SchemeLoader::parseLine(string_view line)
+{
+    ++m_line;
+    string_view rest = trim(line);
+    if(rest.empty() || rest.front()=='#')return;
+
+    string_view kind = nextToken(rest), keyname = nextToken(rest), module;
+    if(!isTypeName(keyname,false))throw SyntaxError(m_line,"invalid name '"+string(keyname)+"'");
+    if(string_view next = rest; nextToken(next)=="in")
+    {
+        module = nextToken(next); rest = next;
+        if(module.empty())throw SyntaxError(m_line,"missing module");
+    }
+    rest = trim(rest);
+
+    if(kind=="class" || kind=="struct")
+    {
+        m_template_params.clear();
+        if(!rest.empty())
+        {
+            if(string_view word = nextToken(rest); word!="template")
+                throw SyntaxError(m_line,"unexpected '"+string(word)+"'");
+            for(size_t end = 0; end!=string_view::npos; rest.remove_prefix(end+1))
+            {
+                end = rest.find(',');
+                string_view param = trim(rest.substr(0,end));
+                if(!isWord(param))throw SyntaxError(m_line,"invalid template parameter '"+string(param)+"'");
+                m_template_params.push_back(param);
+                if(end==string_view::npos)break;
+            }
+        }
+        Span<string_view> params(m_template_params.data(),m_template_params.data()+m_template_params.size());
+        if(kind=="class")m_arena->add(keyname,m_arena->make<ClassTypeInfo>(module,params));
+        else m_arena->add(keyname,m_arena->make<StructTypeInfo>(module,params));
+    }
+    else if(kind=="function")
+    {
+        if(rest.empty() || rest.front()!='=')throw SyntaxError(m_line,"missing '='");
+        size_t open = rest.find('(');
+        if(open==string_view::npos)throw SyntaxError(m_line,"missing '('");
+        if(rest.back()!=')')throw SyntaxError(m_line,"missing ')'");
+
+        m_params.clear();
+        m_params.push_back(parseParam(rest.substr(1,open-1)));
+        string_view list = trim(rest.substr(open+1,rest.size()-open-2));
+        if(!list.empty())for(size_t end = 0; ; list.remove_prefix(end+1))
+        {
+            end = list.find(',');
+            m_params.push_back(parseParam(list.substr(0,end)));
+            if(end==string_view::npos)break;
+        }
+        Span<FunctionParamView> params(m_params.data(),m_params.data()+m_params.size());
+        m_arena->add(keyname,m_arena->make<FunctionTypeInfo>(module,params));
+    }
+    else throw SyntaxError(m_line,"unknown kind '"+string(kind)+"'");
+}
+
+FunctionParamView SchemeLoader::parseParam(string_view text) const
+{
+    FunctionParamView param{trim(text),false,0};
+    if(param.keyname.size()>5 && param.keyname.compare(0,5,"const")==0 && isSpace(param.keyname[5]))
+        { param.cnst = true; param.keyname = trim(param.keyname.substr(6)); }
+    while(!param.keyname.empty() && param.keyname.back()=='*')
+        { ++param.refpow; param.keyname = trim(param.keyname.substr(0,param.keyname.size()-1)); }
+    if(!isTypeName(param.keyname,true))throw SyntaxError(m_line,"invalid parameter '"+string(trim(text))+"'");
+    param.kept = &m_arena->intern(param.keyname);
+    return param;
+}
@@ -0,0 +1,64 @@
+/*
+file:   SchemeLoader.h
+
+author:	Aleksey Yakovlev
+data:	October 16, 2026
+
+Loader of the text scheme definitions for a task on the topic of code generation.
+
+The scheme is a text of lines, one type per line, the empty lines and the lines
+starting with '#' are skipped:
+
+    class std::string in <string>
+    struct my_library::quick in my_library.h template T1, T2, T3
+    function my_library::func1 = void* (std::string, const my_library::awesome*)
+
+A class or a struct may have a module and a list of template parameters.
+A function may have a module and is followed by the result and the parameters,
+each of them may be 'const' and may have any number of pointer stars.
+The lines are parsed in place by 'std::string_view' tokens, the input is a whole
+buffer, as a mapped file, or a sequence of chunks splitting the lines anywhere.
+The types are made in a 'CodegenAPI::SchemeArena', which 'CodegenAPI::Codegen'
+is constructed from. A malformed line is reported by 'CodegenAPI::SyntaxError'
+with its number.
+*/
+
+#ifndef SCHEME_LOADER_H
+#define SCHEME_LOADER_H
+
+#include <istream>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "SchemeArena.h"
+
+namespace CodegenAPI
+{
+    class SchemeLoader
+    {
+    protected:
+        std::shared_ptr<SchemeArena> m_arena;
+        std::size_t m_line = 0;
+        std::string m_partial;
+        std::vector<std::string_view> m_template_params;
+        std::vector<FunctionParamView> m_params;
+
+        void parseLine(std::string_view line);
+        FunctionParamView parseParam(std::string_view text) const;
+    public:
+        explicit SchemeLoader(std::shared_ptr<SchemeArena> arena = std::make_shared<SchemeArena>())
+            : m_arena(std::move(arena)) { }
+
+        //the chunk may end in the middle of a line, which is completed by the next chunk
+        void feed(std::string_view chunk);
+        //parses the last line and returns the arena with the loaded types
+        std::shared_ptr<SchemeArena> finish();
+
+        static std::shared_ptr<SchemeArena> parse(std::string_view text);
+        static std::shared_ptr<SchemeArena> load(const std::string &path);
+        static std::shared_ptr<SchemeArena> read(std::istream &stream, std::size_t chunk = 1<<16);
+    };
+}
+#endif
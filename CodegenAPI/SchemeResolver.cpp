@@ -0,0 +1,243 @@
+/*
+file:   SchemeResolver.cpp
+
+author:	Aleksey Yakovlev
+data:	October 16, 2026
+
+Resolvers of the types by their names for a task on the topic of code generation.
+*/
+
+#include "pch.h"
+#include "SchemeResolver.h"
+#include "SchemeLoader.h"
+#include "OutputSink.h"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <queue>
+#include <system_error>
+
+using namespace CodegenAPI;
+using namespace std;
+
+
+
+map<LongName,shared_ptr<TypeInfo>> SchemeResolver::closure(const vector<LongName> &names,
+    const set<LongName> &applied, const map<LongName,shared_ptr<TypeInfo>> &known)
+{
+    map<LongName,shared_ptr<TypeInfo>> scheme;
+    set<LongName> missing;
+    queue<LongName> depends;
+    for(const LongName &name : names)depends.push(name);
+    for(; !depends.empty(); depends.pop())
+    {
+        const LongName &keyname = depends.front();
+        if(applied.count(keyname) || scheme.count(keyname) || missing.count(keyname))continue;
+        shared_ptr<TypeInfo> info;
+        if(auto known_it = known.find(keyname); known_it!=known.end())info = known_it->second;
+        else info = resolve(keyname);
+        if(!info){ missing.insert(keyname); continue; }
+        if(!info->isExternal())for(LongName &depname : info->dependencies())depends.push(move(depname));
+        scheme.emplace(keyname,move(info));
+    }
+    return scheme;
+}
+
+
+
+shared_ptr<TypeInfo> CachedResolver::resolve(string_view keyname)
+{
+    {
+        lock_guard lock(m_mutex);
+        if(auto entry_it = m_entries.find(keyname); entry_it!=m_entries.end())
+        {
+            ++m_hits;
+            m_order.splice(m_order.begin(),m_order,entry_it->second);
+            return entry_it->second->second;
+        }
+        ++m_misses;
+    }
+
+    //the source is asked outside the lock, two threads may resolve the same key at once
+    shared_ptr<TypeInfo> info = m_source->resolve(keyname);
+    lock_guard lock(m_mutex);
+    if(m_entries.count(keyname))return info;
+    m_order.emplace_front(LongName(keyname),info);
+    m_entries.emplace(m_order.front().first,m_order.begin());
+    if(m_order.size()>m_capacity)
+    {
+        m_entries.erase(m_order.back().first);
+        m_order.pop_back();
+    }
+    return info;
+}
+
+
+
+static const char IndexMagic[8] = {'C','G','I','N','D','E','X','\0'};
+
+//the key is the second token of a line, the line is checked by the loader when the index is built
+static string_view lineKey(string_view line)
+{
+    auto skipSpaces = [&line]() { while(!line.empty() && (line.front()==' ' || line.front()=='\t'))line.remove_prefix(1); };
+    auto takeToken = [&line]()
+    {
+        size_t end = 0;
+        while(end<line.size() && line[end]!=' ' && line[end]!='\t' && line[end]!='\r')++end;
+        string_view token = line.substr(0,end); line.remove_prefix(end);
+        return token;
+    };
+    skipSpaces(); takeToken(); skipSpaces();
+    return takeToken();
+}
+
+uint64_t IndexResolver::hash(string_view keyname)
+{
+    //FNV-1a, the shard and the place in the shard are taken from the same hash
+    uint64_t value = 0xcbf29ce484222325;
+    for(char ch : keyname){ value ^= static_cast<unsigned char>(ch); value *= 0x100000001b3; }
+    return value;
+}
+
+string IndexResolver::shardPath(const string &directory, uint32_t shard, const char suffix[])
+{
+    return (filesystem::path(directory)/("shard_"+to_string(shard)+suffix)).string();
+}
+
+IndexResolver::IndexResolver(string directory) : m_directory(move(directory)), m_shard_count(0)
+{
+    string path = shardPath(m_directory,0,".index");
+    MappedFile index(path);
+    Header header;
+    if(index.size()<sizeof(header))throw InputError(path);
+    memcpy(&header,index.data(),sizeof(header));
+    if(memcmp(header.magic,IndexMagic,sizeof(IndexMagic))!=0 || header.version!=Version || header.shards==0)
+        throw InputError(path);
+    m_shard_count = header.shards;
+    m_shards.reset(new atomic<Shard*>[m_shard_count]());
+}
+
+IndexResolver::~IndexResolver()
+{
+    for(uint32_t i=0; i<m_shard_count; ++i)delete m_shards[i].load();
+}
+
+const IndexResolver::Shard& IndexResolver::shard(uint32_t number)
+{
+    //a shard is mapped by the first lookup reaching it and stays mapped,
+    //the lookups after it read the published pointer with no lock
+    if(const Shard *mapped = m_shards[number].load(memory_order_acquire))return *mapped;
+    lock_guard lock(m_mutex);
+    Shard *shard = m_shards[number].load(memory_order_relaxed);
+    if(!shard)
+    {
+        auto mapped = make_unique<Shard>();
+        string path = shardPath(m_directory,number,".index");
+        mapped->index = make_unique<MappedFile>(path);
+        mapped->lines = make_unique<MappedFile>(shardPath(m_directory,number,".scheme"));
+
+        Header header;
+        if(mapped->index->size()<sizeof(header))throw InputError(path);
+        memcpy(&header,mapped->index->data(),sizeof(header));
+        if(memcmp(header.magic,IndexMagic,sizeof(IndexMagic))!=0 || header.version!=Version ||
+            header.shards!=m_shard_count || mapped->index->size()!=sizeof(header)+header.entries*sizeof(Entry))
+            throw InputError(path);
+        shard = mapped.release();
+        m_shards[number].store(shard,memory_order_release);
+    }
+    return *shard;
+}
+
+shared_ptr<TypeInfo> IndexResolver::resolve(string_view keyname)
+{
+    uint64_t key_hash = hash(keyname);
+    uint32_t number = static_cast<uint32_t>(key_hash%m_shard_count);
+    const Shard &found = shard(number);
+    const Entry *first = reinterpret_cast<const Entry*>(found.index->data()+sizeof(Header));
+    const Entry *last = reinterpret_cast<const Entry*>(found.index->data()+found.index->size());
+    string_view lines = found.lines->view();
+
+    first = lower_bound(first,last,key_hash,[](const Entry &entry, uint64_t value) { return entry.hash<value; });
+    for(; first!=last && first->hash==key_hash; ++first)
+    {
+        if(uint64_t(first->offset)+first->size>lines.size())throw InputError(shardPath(m_directory,number,".scheme"));
+        string_view line = lines.substr(first->offset,first->size);
+        if(lineKey(line)!=keyname)continue;
+
+        //the type keeps its small arena alive
+        SchemeLoader loader(make_shared<SchemeArena>(512));
+        loader.feed(line);
+        shared_ptr<SchemeArena> arena = loader.finish();
+        return shared_ptr<TypeInfo>(arena,arena->entries().front().second);
+    }
+    return nullptr;
+}
+
+void IndexResolver::build(const string &scheme_path, const string &directory, uint32_t shards)
+{
+    if(shards==0)throw InputError("shard count");
+    error_code error;
+    filesystem::create_directories(directory,error);
+    if(!filesystem::is_directory(directory))throw OutputError(directory);
+
+    vector<unique_ptr<FileSink>> sinks;
+    vector<vector<Entry>> entries(shards);
+    vector<uint32_t> sizes(shards);
+    for(uint32_t i=0; i<shards; ++i)sinks.push_back(make_unique<FileSink>(shardPath(directory,i,".scheme"),1<<14));
+
+    MappedFile scheme(scheme_path);
+    string_view text = scheme.view();
+    for(size_t number = 1; !text.empty(); ++number)
+    {
+        size_t end = text.find('\n');
+        string_view line = text.substr(0,end);
+        text.remove_prefix(end==string_view::npos ? text.size() : end+1);
+
+        //every line is parsed alone, so the error is renumbered by its place in the scheme
+        SchemeLoader loader(make_shared<SchemeArena>(512));
+        try { loader.feed(line); if(loader.finish()->entries().empty())continue; }
+        catch(const SyntaxError &ex)
+        {
+            string reason = ex.what();
+            throw SyntaxError(number,reason.substr(reason.find(": ")+2));
+        }
+
+        uint64_t key_hash = hash(lineKey(line));
+        uint32_t shard = static_cast<uint32_t>(key_hash%shards);
+        if(uint64_t(sizes[shard])+line.size()+1>UINT32_MAX)throw OutputError(shardPath(directory,shard,".scheme"));
+        entries[shard].push_back({key_hash,sizes[shard],static_cast<uint32_t>(line.size())});
+        *sinks[shard]<<line<<'\n';
+        sizes[shard] += static_cast<uint32_t>(line.size()+1);
+    }
+    for(unique_ptr<FileSink> &sink : sinks)sink->close();
+
+    for(uint32_t i=0; i<shards; ++i)
+    {
+        vector<Entry> &shard = entries[i];
+        stable_sort(begin(shard),end(shard),[](const Entry &lhs, const Entry &rhs) { return lhs.hash<rhs.hash; });
+
+        //the keys of a hash are compared by the lines written to the shard
+        if(adjacent_find(begin(shard),end(shard),[](const Entry &lhs, const Entry &rhs) { return lhs.hash==rhs.hash; })
+            !=end(shard))
+        {
+            MappedFile lines(shardPath(directory,i,".scheme"));
+            for(size_t first = 0, last; first<shard.size(); first = last)
+            {
+                for(last = first+1; last<shard.size() && shard[last].hash==shard[first].hash; ++last)
+                    for(size_t k=first; k<last; ++k)
+                        if(string_view key = lineKey(lines.view().substr(shard[last].offset,shard[last].size));
+                            key==lineKey(lines.view().substr(shard[k].offset,shard[k].size)))
+                            throw DuplicateKeyError(string(key));
+            }
+        }
+
+        Header header;
+        memcpy(header.magic,IndexMagic,sizeof(header.magic));
+        header.version = Version; header.shards = shards; header.entries = shard.size();
+        FileSink sink(shardPath(directory,i,".index"));
+        sink<<string_view(reinterpret_cast<const char*>(&header),sizeof(header));
+        if(!shard.empty())sink<<string_view(reinterpret_cast<const char*>(shard.data()),shard.size()*sizeof(Entry));
+        sink.close();
+    }
+}
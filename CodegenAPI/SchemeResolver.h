@@ -0,0 +1,124 @@
+/*
+file:   SchemeResolver.h
+
+author:	Aleksey Yakovlev
+data:	October 16, 2026
+
+Resolvers of the types by their names for a task on the topic of code generation.
+
+A 'Codegen' constructed from a resolver never holds the whole scheme: a request
+resolves the names it reaches, from the declared and the included names along
+the dependencies, and is generated over these types only. The 'CachedResolver'
+keeps the last resolved types up to its capacity, the least recently used one
+goes first, and remembers the missing names the same way.
+
+The 'IndexResolver' reads the types from an index built of a text scheme by
+'IndexResolver::build'. The lines of the scheme are split into the shards by
+the hash of their names; a shard is a text file of its lines and a file of
+the sorted hashes with the positions of the lines. The shards are mapped when
+they are reached first and published by atomic pointers, so the lookups of a mapped
+shard take no lock, and a resolved line is parsed into its own small arena, so the
+heap holds the resolved types only.
+*/
+
+#ifndef SCHEME_RESOLVER_H
+#define SCHEME_RESOLVER_H
+
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "MappedFile.h"
+#include "TypeInfo.h"
+
+namespace CodegenAPI
+{
+    class SchemeResolver
+    {
+    public:
+        virtual ~SchemeResolver() = default;
+
+        //the type of the key or null when there is no such key; it is called by several threads at once
+        virtual std::shared_ptr<TypeInfo> resolve(std::string_view keyname) = 0;
+
+        //the types of the names and of the dependencies of the types declared by them, an external type
+        //is taken without its dependencies; the known types go first, the missing names are left out
+        std::map<LongName,std::shared_ptr<TypeInfo>> closure(const std::vector<LongName> &names,
+            const std::set<LongName> &applied, const std::map<LongName,std::shared_ptr<TypeInfo>> &known = {});
+    };
+
+    class CachedResolver : public SchemeResolver
+    {
+    protected:
+        using Entry = std::pair<LongName,std::shared_ptr<TypeInfo>>;
+
+        std::shared_ptr<SchemeResolver> m_source;
+        std::size_t m_capacity;
+        std::mutex m_mutex;
+        std::list<Entry> m_order;
+        std::unordered_map<std::string_view,std::list<Entry>::iterator> m_entries;
+        std::uint64_t m_hits = 0;
+        std::uint64_t m_misses = 0;
+    public:
+        CachedResolver(std::shared_ptr<SchemeResolver> source, std::size_t capacity)
+            : m_source(std::move(source)), m_capacity(capacity>0 ? capacity : 1) { }
+
+        std::shared_ptr<TypeInfo> resolve(std::string_view keyname) override;
+
+        std::size_t size() { std::lock_guard lock(m_mutex); return m_order.size(); }
+        std::uint64_t hits() { std::lock_guard lock(m_mutex); return m_hits; }
+        std::uint64_t misses() { std::lock_guard lock(m_mutex); return m_misses; }
+    };
+
+    class IndexResolver : public SchemeResolver
+    {
+    public:
+        static constexpr std::uint32_t Version = 1;
+    protected:
+        struct Header
+        {
+            char magic[8];
+            std::uint32_t version;
+            std::uint32_t shards;
+            std::uint64_t entries;
+        };
+        struct Entry { std::uint64_t hash; std::uint32_t offset; std::uint32_t size; };
+        struct Shard
+        {
+            std::unique_ptr<MappedFile> index;
+            std::unique_ptr<MappedFile> lines;
+        };
+
+        std::string m_directory;
+        std::uint32_t m_shard_count;
+        //the lock serializes only the mapping of the shards
+        std::mutex m_mutex;
+        std::unique_ptr<std::atomic<Shard*>[]> m_shards;
+
+        static std::uint64_t hash(std::string_view keyname);
+        static std::string shardPath(const std::string &directory, std::uint32_t shard, const char suffix[]);
+        const Shard& shard(std::uint32_t number);
+    public:
+        //the shard count is read from the first shard
+        explicit IndexResolver(std::string directory);
+        IndexResolver(const IndexResolver&) = delete;
+        IndexResolver& operator=(const IndexResolver&) = delete;
+        ~IndexResolver() override;
+
+        std::shared_ptr<TypeInfo> resolve(std::string_view keyname) override;
+        std::uint32_t shards() const { return m_shard_count; }
+
+        //the scheme file is read line by line, every line is checked by the loader
+        //and the duplicate keys are reported by 'DuplicateKeyError'
+        static void build(const std::string &scheme_path, const std::string &directory, std::uint32_t shards = 64);
+    };
+}
+#endif
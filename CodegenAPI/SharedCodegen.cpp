@@ -0,0 +1,118 @@
+/*
+file:   SharedCodegen.cpp
+
+author:	Aleksey Yakovlev
+data:	October 16, 2026
+
+Concurrently replaced generator for a task on the topic of code generation.
+*/
+
+#include "pch.h"
+#include "SharedCodegen.h"
+
+#include <algorithm>
+#include <thread>
+#include <unordered_map>
+
+using namespace CodegenAPI;
+using namespace std;
+
+
+
+//the slots of a thread by the identifiers of the generators, which are never reused;
+//the slots are given back when the thread exits, a slot outlives its generator if needed
+template <class Slot> struct ThreadSlots
+{
+    unordered_map<uint64_t,shared_ptr<Slot>> slots;
+    uint64_t last_id = 0;
+    Slot *last_slot = nullptr;
+
+    ~ThreadSlots() { for(auto & [id, slot] : slots)slot->owned.store(false,memory_order_release); }
+};
+
+static atomic<uint64_t> sharedCodegenIds{0};
+
+SharedCodegen::SharedCodegen(shared_ptr<const Codegen> codegen)
+    : m_current(codegen.get()), m_epoch(1), m_retired_count(0), m_id(++sharedCodegenIds), m_owner(move(codegen)),
+    m_first_slot(nullptr)
+{
+}
+
+SharedCodegen::ReaderSlot& SharedCodegen::slot()
+{
+    static thread_local ThreadSlots<ReaderSlot> thread_slots;
+    if(thread_slots.last_id==m_id)return *thread_slots.last_slot;
+
+    shared_ptr<ReaderSlot> &found = thread_slots.slots[m_id];
+    if(!found)
+    {
+        //a slot given back by an exited thread is taken first
+        lock_guard lock(m_mutex);
+        for(const shared_ptr<ReaderSlot> &free_slot : m_slots)
+            if(bool expected = false; free_slot->owned.compare_exchange_strong(expected,true))
+                { found = free_slot; break; }
+        if(!found)
+        {
+            found = make_shared<ReaderSlot>();
+            found->owned.store(true);
+            found->next = m_first_slot.load();
+            m_slots.push_back(found);
+            m_first_slot.store(found.get());
+        }
+    }
+    thread_slots.last_id = m_id; thread_slots.last_slot = found.get();
+    return *found;
+}
+
+SharedCodegen::Reader::Reader(SharedCodegen &shared, ReaderSlot &slot) : m_shared(&shared), m_slot(&slot)
+{
+    //the epoch is announced before the version is read, so a writer scanning the slots
+    //either sees the epoch or has replaced the version before it is read
+    if(slot.depth++==0)slot.epoch.store(shared.m_epoch.load());
+    m_codegen = shared.m_current.load();
+}
+
+void SharedCodegen::leave(ReaderSlot &slot)
+{
+    if(--slot.depth>0)return;
+    //the exit is ordered before the count is read, so either this reader sees the retired
+    //versions or the writer retiring them sees the exit
+    uint64_t epoch = slot.epoch.exchange(0);
+    if(m_retired_count.load()==0 || epoch>=m_epoch.load())return;
+
+    //a reader entered no later than this one holds all the versions this one held and drops
+    //them when it leaves; of the readers leaving at once the last to look sees none of the others
+    for(const ReaderSlot *other = m_first_slot.load(); other; other = other->next)
+        if(uint64_t other_epoch = other->epoch.load(); other_epoch!=0 && other_epoch<=epoch)return;
+    vector<Retired> dropped;
+    lock_guard lock(m_mutex);
+    dropped = reclaim();
+}
+
+void SharedCodegen::publish(shared_ptr<const Codegen> codegen)
+{
+    //the dropped versions are destroyed after the lock is released
+    vector<Retired> dropped;
+    lock_guard lock(m_mutex);
+    m_current.store(codegen.get());
+    uint64_t epoch = m_epoch.fetch_add(1)+1;
+    m_retired.push_back({move(m_owner),epoch});
+    //the count is raised before the slots are scanned, so a reader leaving meanwhile sees it
+    m_retired_count.store(m_retired.size());
+    m_owner = move(codegen);
+    dropped = reclaim();
+}
+
+vector<SharedCodegen::Retired> SharedCodegen::reclaim()
+{
+    //a version retired in an epoch is read only by the readers which entered before it
+    uint64_t oldest = UINT64_MAX;
+    for(const shared_ptr<ReaderSlot> &slot : m_slots)
+        if(uint64_t epoch = slot->epoch.load(); epoch!=0)oldest = min(oldest,epoch);
+    auto kept = partition(begin(m_retired),end(m_retired),
+        [oldest](const Retired &retired) { return retired.epoch>oldest; });
+    vector<Retired> dropped(make_move_iterator(kept),make_move_iterator(end(m_retired)));
+    m_retired.erase(kept,end(m_retired));
+    m_retired_count.store(m_retired.size());
+    return dropped;
+}
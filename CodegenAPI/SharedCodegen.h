@@ -0,0 +1,122 @@
+/*
+file:   SharedCodegen.h
+
+author:	Aleksey Yakovlev
+data:	October 16, 2026
+
+Concurrently replaced generator for a task on the topic of code generation.
+
+A 'SharedCodegen' holds the current version of a 'Codegen', which is never changed
+after it is published, so the readers generate from it with no locks. A writer
+publishes a new version at once for the readers coming after it, the readers which
+came before keep the version they have.
+
+The versions are reclaimed by epochs. A reader thread has a slot of its own, which
+tells the epoch the thread entered in or zero while it is outside; the entry and
+the exit write only this slot, so the readers do not contend with each other.
+A replaced version is retired with the epoch of its replacement and dropped when
+no reader has entered in an earlier epoch, by the next publication or by the exit
+of its last reader. Only an exiting reader which entered before the current version
+and finds no older reader left scans the slots under the lock, the others leave
+without it, and the dropped versions are destroyed after the lock is released.
+
+A new version is made by a copy of the current one, which is edited and published:
+the copy takes its own interned names at the first edit, so the edits do not touch
+the version the readers are generating from.
+*/
+
+#ifndef SHARED_CODEGEN_H
+#define SHARED_CODEGEN_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "CodegenAPI.h"
+
+namespace CodegenAPI
+{
+    class SharedCodegen
+    {
+    protected:
+        //the slot is padded to a cache line of its own
+        struct alignas(64) ReaderSlot
+        {
+            std::atomic<std::uint64_t> epoch{0};
+            std::atomic<bool> owned{false};
+            //the nesting of the readers of the owner thread, only the outer one enters
+            std::size_t depth = 0;
+            //the slots are linked for the exiting readers, which scan them with no lock
+            ReaderSlot *next = nullptr;
+        };
+        struct Retired
+        {
+            std::shared_ptr<const Codegen> codegen;
+            std::uint64_t epoch;
+        };
+
+        std::atomic<const Codegen*> m_current;
+        std::atomic<std::uint64_t> m_epoch;
+        std::atomic<std::size_t> m_retired_count;
+        std::uint64_t m_id;
+        std::mutex m_mutex;
+        std::shared_ptr<const Codegen> m_owner;
+        std::vector<Retired> m_retired;
+        std::vector<std::shared_ptr<ReaderSlot>> m_slots;
+        std::atomic<ReaderSlot*> m_first_slot;
+
+        ReaderSlot& slot();
+        void leave(ReaderSlot &slot);
+        //takes the versions no reader can hold any more, called under the lock
+        std::vector<Retired> reclaim();
+    public:
+        //a reader stays on the thread which acquired it, the version lives as long as the reader
+        class Reader
+        {
+            friend class SharedCodegen;
+        protected:
+            SharedCodegen *m_shared;
+            ReaderSlot *m_slot;
+            const Codegen *m_codegen;
+
+            Reader(SharedCodegen &shared, ReaderSlot &slot);
+        public:
+            Reader(Reader &&other) noexcept
+                : m_shared(other.m_shared), m_slot(other.m_slot), m_codegen(other.m_codegen) { other.m_slot = nullptr; }
+            Reader(const Reader&) = delete;
+            Reader& operator=(const Reader&) = delete;
+            ~Reader() { if(m_slot)m_shared->leave(*m_slot); }
+
+            const Codegen& operator*() const { return *m_codegen; }
+            const Codegen* operator->() const { return m_codegen; }
+        };
+
+        explicit SharedCodegen(std::shared_ptr<const Codegen> codegen);
+        SharedCodegen(const SharedCodegen&) = delete;
+        SharedCodegen& operator=(const SharedCodegen&) = delete;
+        //no reader may be left
+        ~SharedCodegen() = default;
+
+        Reader read() { return Reader(*this,slot()); }
+        //the version must not be changed after it is published, the writers are serialized
+        void publish(std::shared_ptr<const Codegen> codegen);
+
+        //the count of the publications after the first version
+        std::uint64_t version() const { return m_epoch.load()-1; }
+        //the count of the replaced versions waiting for their readers
+        std::size_t retired() const { return m_retired_count.load(); }
+
+        std::string source(const std::vector<LongName> &include_names, const std::vector<LongName> &declare_names,
+            CodegenStats *stats = nullptr)
+            { return read()->source(include_names,declare_names,stats); }
+        void source(OutputSink &sink, const std::vector<LongName> &include_names,
+            const std::vector<LongName> &declare_names, CodegenStats *stats = nullptr)
+            { read()->source(sink,include_names,declare_names,stats); }
+        IntermediateCode code(const std::vector<LongName> &include_names, const std::vector<LongName> &declare_names,
+            CodegenStats *stats = nullptr)
+            { return read()->code(include_names,declare_names,stats); }
+    };
+}
+#endif
@@ -0,0 +1,219 @@
+/*
+file:   Snapshot.cpp
+
+author:	Aleksey Yakovlev
+data:	October 16, 2026
+
+Memory mapped binary snapshot of the meta information for a task on the topic
+of code generation.
+*/
+
+#include "pch.h"
+#include "Snapshot.h"
+#include "CodegenAPI.h"
+
+#include <cstring>
+#include <limits>
+
+using namespace CodegenAPI;
+using namespace std;
+
+static const char SnapshotMagic[8] = {'C','G','S','N','A','P','\0','\0'};
+static const uint32_t SnapshotOrder = 0x01020304u;
+
+//every section starts at a multiple of eight bytes
+static size_t alignSection(size_t offset) { return (offset+7)&~size_t(7); }
+
+
+
+void Snapshot::write(OutputSink &sink, const InternedScheme &scheme,
+    const map<NameId,string> &rejected)
+{
+    //the template parameters are kept by the name table as well
+    NameTable table(*scheme.names());
+    for(NameId id = 0; id<scheme.size(); ++id)
+        if(const TypeInfo *info = scheme.info(id))
+            for(const auto &param : info->getTemplateParams())table.intern(param);
+    table.reserve(table.size());
+
+    vector<uint32_t> offsets; offsets.reserve(table.size()+1);
+    string chars;
+    for(NameId id = 0; id<table.size(); ++id)
+        { offsets.push_back(static_cast<uint32_t>(chars.size())); chars += table.view(id); }
+    offsets.push_back(static_cast<uint32_t>(chars.size()));
+
+    vector<Entry> entries(table.size(),Entry{Kind::None,0,0,NoName,0,0,0,0});
+    vector<NameId> edges, template_params;
+    vector<Param> params;
+    for(NameId id = 0; id<scheme.size(); ++id)
+    {
+        Entry &entry = entries[id];
+        entry.applied = scheme.isApplied(id);
+        entry.module = scheme.module(id);
+        entry.first_edge = static_cast<uint32_t>(edges.size());
+        for(NameId depname : scheme.dependencies(id))edges.push_back(depname);
+        entry.edge_count = static_cast<uint32_t>(edges.size()-entry.first_edge);
+
+        const TypeInfo *info = scheme.info(id);
+        if(!info)continue;
+        if(auto function = dynamic_cast<const FunctionTypeInfo*>(info))
+        {
+            entry.kind = Kind::Function; entry.first_param = static_cast<uint32_t>(params.size());
+            for(const FunctionParam &param : function->getParams())
+                params.push_back({table.find(param.getKeyName()),param.getRefPow(),param.isConst()});
+            entry.param_count = static_cast<uint32_t>(params.size()-entry.first_param);
+            continue;
+        }
+        if(dynamic_cast<const ClassTypeInfo*>(info))entry.kind = Kind::Class;
+        else if(dynamic_cast<const StructTypeInfo*>(info))entry.kind = Kind::Struct;
+        else throw SnapshotError("unsupported type "+string(scheme.view(id)));
+        entry.first_param = static_cast<uint32_t>(template_params.size());
+        for(const auto &param : info->getTemplateParams())template_params.push_back(table.find(param));
+        entry.param_count = static_cast<uint32_t>(template_params.size()-entry.first_param);
+    }
+
+    vector<Rejected> messages;
+    for(const auto & [keyname, message] : rejected)
+    {
+        messages.push_back({keyname,static_cast<uint32_t>(chars.size()),static_cast<uint32_t>(message.size())});
+        chars += message;
+    }
+    if(chars.size()>numeric_limits<uint32_t>::max())throw SnapshotError("the names exceed 4 GB");
+
+    Header header{};
+    memcpy(header.magic,SnapshotMagic,sizeof(header.magic));
+    header.order = SnapshotOrder; header.version = Version;
+    header.names = static_cast<uint32_t>(table.size());
+    header.slots = static_cast<uint32_t>(table.capacity());
+    header.edges = static_cast<uint32_t>(edges.size());
+    header.params = static_cast<uint32_t>(params.size());
+    header.template_params = static_cast<uint32_t>(template_params.size());
+    header.rejected = static_cast<uint32_t>(messages.size());
+    header.chars = chars.size();
+
+    auto section = [&sink](const void *data, size_t size)
+    {
+        sink.write(static_cast<const char*>(data),size);
+        sink.fill('\0',alignSection(size)-size);
+    };
+    section(&header,sizeof(header));
+    section(offsets.data(),offsets.size()*sizeof(uint32_t));
+    section(table.slots(),table.capacity()*sizeof(NameTable::Slot));
+    section(entries.data(),entries.size()*sizeof(Entry));
+    section(edges.data(),edges.size()*sizeof(NameId));
+    section(params.data(),params.size()*sizeof(Param));
+    section(template_params.data(),template_params.size()*sizeof(NameId));
+    section(messages.data(),messages.size()*sizeof(Rejected));
+    section(chars.data(),chars.size());
+    sink.flush();
+}
+
+
+
+shared_ptr<const Snapshot> Snapshot::open(const string &path)
+{
+    auto snapshot = make_shared<Snapshot>();
+    snapshot->m_file = make_unique<MappedFile>(path);
+    snapshot->bind();
+    return snapshot;
+}
+
+void Snapshot::bind()
+{
+    const char *data = m_file->data(); size_t size = m_file->size();
+    if(size<sizeof(Header))throw SnapshotError("truncated file");
+    m_header = reinterpret_cast<const Header*>(data);
+    if(memcmp(m_header->magic,SnapshotMagic,sizeof(SnapshotMagic))!=0)throw SnapshotError("not a snapshot");
+    if(m_header->order!=SnapshotOrder)throw SnapshotError("foreign byte order");
+    if(m_header->version!=Version)throw SnapshotError("unsupported version "+to_string(m_header->version));
+    if(m_header->slots<2*size_t(m_header->names) || (m_header->slots&(m_header->slots-1))!=0)
+        throw SnapshotError("malformed name index");
+
+    //the sections follow the header in the order they are written
+    size_t offset = alignSection(sizeof(Header));
+    auto take = [data,size,&offset](size_t bytes)
+    {
+        if(offset>size || bytes>size-offset)throw SnapshotError("truncated file");
+        const char *first = data+offset;
+        offset = alignSection(offset+bytes);
+        return first;
+    };
+    m_offsets = reinterpret_cast<const uint32_t*>(take((size_t(m_header->names)+1)*sizeof(uint32_t)));
+    m_slots = reinterpret_cast<const NameTable::Slot*>(take(m_header->slots*sizeof(NameTable::Slot)));
+    m_entries = reinterpret_cast<const Entry*>(take(m_header->names*sizeof(Entry)));
+    m_edges = reinterpret_cast<const NameId*>(take(m_header->edges*sizeof(NameId)));
+    m_params = reinterpret_cast<const Param*>(take(m_header->params*sizeof(Param)));
+    m_template_params = reinterpret_cast<const NameId*>(take(m_header->template_params*sizeof(NameId)));
+    m_rejected = reinterpret_cast<const Rejected*>(take(m_header->rejected*sizeof(Rejected)));
+    m_chars = take(m_header->chars);
+    if(m_offsets[m_header->names]>m_header->chars)throw SnapshotError("malformed names");
+
+    m_infos.reset(new atomic<TypeInfo*>[m_header->names]());
+    m_texts.reset(new atomic<const LongName*>[m_header->names]());
+}
+
+Snapshot::~Snapshot()
+{
+    if(m_infos)for(size_t id = 0; id<size(); ++id)delete m_infos[id].load();
+    if(m_texts)for(size_t id = 0; id<size(); ++id)delete m_texts[id].load();
+}
+
+
+
+shared_ptr<NameTable> Snapshot::names() const
+{
+    return make_shared<NameTable>(shared_from_this(),m_chars,m_offsets,m_header->names,m_slots,m_header->slots);
+}
+
+const TypeInfo* Snapshot::info(NameId id) const
+{
+    if(id>=size() || m_entries[id].kind==Kind::None)return nullptr;
+    if(TypeInfo *info = m_infos[id].load(memory_order_acquire))return info;
+
+    //the threads may decode the same type at once, the first stored object wins
+    unique_ptr<TypeInfo> decoded = decode(id);
+    TypeInfo *expected = nullptr;
+    if(m_infos[id].compare_exchange_strong(expected,decoded.get(),memory_order_acq_rel))return decoded.release();
+    return expected;
+}
+
+const LongName& Snapshot::text(NameId id) const
+{
+    if(const LongName *text = m_texts[id].load(memory_order_acquire))return *text;
+    auto made = make_unique<const LongName>(name(id));
+    const LongName *expected = nullptr;
+    if(m_texts[id].compare_exchange_strong(expected,made.get(),memory_order_acq_rel))return *made.release();
+    return *expected;
+}
+
+unique_ptr<TypeInfo> Snapshot::decode(NameId id) const
+{
+    const Entry &entry = m_entries[id];
+    string_view module = entry.module==NoName ? string_view() : name(entry.module);
+    if(entry.kind==Kind::Function)
+    {
+        vector<FunctionParamView> params; params.reserve(entry.param_count);
+        for(const Param *param = m_params+entry.first_param, *last = param+entry.param_count; param!=last; ++param)
+        {
+            //the parameters refer to the name kept by the snapshot instead of copying it
+            const LongName &keyname = text(param->keyname);
+            params.push_back({keyname,param->cnst!=0,param->refpow,&keyname});
+        }
+        return make_unique<FunctionTypeInfo>(module,Span<FunctionParamView>(params.data(),params.data()+params.size()));
+    }
+
+    vector<string_view> template_params; template_params.reserve(entry.param_count);
+    for(const NameId *param = m_template_params+entry.first_param, *last = param+entry.param_count; param!=last; ++param)
+        template_params.push_back(name(*param));
+    Span<string_view> span(template_params.data(),template_params.data()+template_params.size());
+    if(entry.kind==Kind::Class)return make_unique<ClassTypeInfo>(module,span);
+    return make_unique<StructTypeInfo>(module,span);
+}
+
+vector<pair<NameId,string>> Snapshot::rejected() const
+{
+    vector<pair<NameId,string>> messages;
+    for(const Rejected *error = m_rejected, *last = error+m_header->rejected; error!=last; ++error)
+        messages.emplace_back(error->keyname,string(m_chars+error->first,error->size));
+    return messages;
+}
@@ -0,0 +1,129 @@
+/*
+file:   Snapshot.h
+
+author:	Aleksey Yakovlev
+data:	October 16, 2026
+
+Memory mapped binary snapshot of the meta information for a task on the topic
+of code generation.
+
+The snapshot keeps the interned names with their hash index, the module names,
+the dependencies, the template parameters and the function parameters of a scheme
+in flat arrays of fixed size records. The file is mapped as it is: the names and
+their index serve the lookups in place, the dependencies are read from the mapped
+edge array, and a type description is decoded only when it is requested first.
+Opening a snapshot checks the header only, so the start of a large scheme is
+bounded by the page faults of the data the generation actually reaches.
+
+The records use the native byte order, which is checked by the header together
+with the format version. The records behind the header are trusted, the snapshots
+are written by 'CodegenAPI::Codegen::save'.
+*/
+
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <atomic>
+#include <cstdint>
+#include <exception>
+#include <map>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "MappedFile.h"
+#include "NameTable.h"
+#include "TypeInfo.h"
+
+namespace CodegenAPI
+{
+    class InternedScheme;
+
+    class Snapshot : public std::enable_shared_from_this<Snapshot>
+    {
+    public:
+        static constexpr std::uint32_t Version = 1;
+    protected:
+        enum class Kind : std::uint8_t { None, Class, Struct, Function };
+
+        struct Header
+        {
+            char magic[8];
+            std::uint32_t order;
+            std::uint32_t version;
+            std::uint32_t names;
+            std::uint32_t slots;
+            std::uint32_t edges;
+            std::uint32_t params;
+            std::uint32_t template_params;
+            std::uint32_t rejected;
+            std::uint64_t chars;
+        };
+
+        //the parameters are the function parameters or the template parameters by the kind
+        struct Entry
+        {
+            Kind kind;
+            std::uint8_t applied;
+            std::uint16_t reserved;
+            NameId module;
+            std::uint32_t first_edge;
+            std::uint32_t edge_count;
+            std::uint32_t first_param;
+            std::uint32_t param_count;
+        };
+        struct Param { NameId keyname; std::int32_t refpow; std::uint32_t cnst; };
+        struct Rejected { NameId keyname; std::uint32_t first; std::uint32_t size; };
+
+        std::unique_ptr<MappedFile> m_file;
+        const Header *m_header = nullptr;
+        const std::uint32_t *m_offsets = nullptr;
+        const NameTable::Slot *m_slots = nullptr;
+        const Entry *m_entries = nullptr;
+        const NameId *m_edges = nullptr;
+        const Param *m_params = nullptr;
+        const NameId *m_template_params = nullptr;
+        const Rejected *m_rejected = nullptr;
+        const char *m_chars = nullptr;
+        std::unique_ptr<std::atomic<TypeInfo*>[]> m_infos;
+        //the names of the function parameters, made once for all the types decoded with them
+        std::unique_ptr<std::atomic<const LongName*>[]> m_texts;
+
+        void bind();
+        std::string_view name(NameId id) const
+            { return std::string_view(m_chars+m_offsets[id],m_offsets[id+1]-m_offsets[id]); }
+        const LongName& text(NameId id) const;
+        std::unique_ptr<TypeInfo> decode(NameId id) const;
+    public:
+        Snapshot() = default;
+        Snapshot(const Snapshot&) = delete;
+        Snapshot& operator=(const Snapshot&) = delete;
+        ~Snapshot();
+
+        static std::shared_ptr<const Snapshot> open(const std::string &path);
+        static void write(OutputSink &sink, const InternedScheme &scheme,
+            const std::map<NameId,std::string> &rejected);
+
+        //the name table refers to the mapped names and keeps the snapshot alive
+        std::shared_ptr<NameTable> names() const;
+        std::size_t size() const { return m_header->names; }
+
+        //the type is decoded by the first request, the later ones return the same object
+        const TypeInfo* info(NameId id) const;
+        //tells a type from a name without decoding it
+        bool hasInfo(NameId id) const { return id<size() && m_entries[id].kind!=Kind::None; }
+        NameId module(NameId id) const { return id<size() ? m_entries[id].module : NoName; }
+        Span<NameId> dependencies(NameId id) const
+        {
+            if(id>=size())return Span<NameId>();
+            const NameId *first = m_edges+m_entries[id].first_edge;
+            return Span<NameId>(first,first+m_entries[id].edge_count);
+        }
+        bool isApplied(NameId id) const { return id<size() && m_entries[id].applied; }
+
+        //the messages of the types rejected by their checks when the snapshot was written
+        std::vector<std::pair<NameId,std::string>> rejected() const;
+    };
+}
+#endif
@@ -0,0 +1,490 @@
+/*
+file:   StaticCodegen.h
+
+author:	Aleksey Yakovlev
+data:	October 16, 2026
+
+Compile-time code generation for a task on the topic of code generation.
+
+A scheme known at the build time is declared as a 'constexpr' array of
+'CodegenAPI::StaticEntry' with the 'StaticClassInfo', 'StaticStructInfo' and
+'StaticFunctionInfo' descriptors, which follow 'ClassTypeInfo', 'StructTypeInfo'
+and 'FunctionTypeInfo'. 'CodegenAPI::StaticCodegen' computes the list of the
+included modules, the namespace grouping and the order of the forwards while
+compiling, and 'source' returns the header in a 'constexpr' character array
+of the exact size given by 'sourceSize'. The text is the same as 'Codegen::source'
+writes for the same scheme and request: every forward is emitted as soon as its
+dependencies are declared, the namespace being rendered first, as the topological
+scheduler of 'Codegen' does.
+
+The errors are reported by 'check' as a 'StaticStatus' for a 'static_assert',
+and 'source' throws the errors of the runtime generator, which fails the compilation
+when it is evaluated while compiling. The module include graph is not supported.
+
+The descriptors and the requests keep their lists inline, so a function has at most
+'StaticTypeInfo::MaxParams' (16) parameters with its result, a type at most
+'StaticTypeInfo::MaxTemplateParams' (8) template parameters and a list of a request
+at most 'StaticNames::MaxNames' (64) names; a longer list throws 'std::length_error'.
+The scheduler scans the whole scheme for every forward it emits and every namespace
+it opens, so the evaluation takes at least O(N^2) steps for N entries, multiplied by
+the count of the parameters, and a large scheme may exceed the constexpr step limit
+of the compiler ('/constexpr:steps', '-fconstexpr-ops-limit'); such a scheme is left
+to the runtime 'Codegen'.
+
+    static constexpr CodegenAPI::StaticEntry scheme[] =
+    {
+        {"std::string", CodegenAPI::StaticClassInfo("<string>")},
+        {"my_library::func1", CodegenAPI::StaticFunctionInfo("", {{"void"}, {"std::string"}})},
+    };
+    constexpr CodegenAPI::StaticCodegen hg(scheme);
+    constexpr CodegenAPI::StaticRequest request{{}, {"my_library::func1"}};
+    static_assert(hg.check(request)==CodegenAPI::StaticStatus::Ok, "wrong scheme");
+    constexpr auto header = hg.source<hg.sourceSize(request)>(request);
+
+The scheme must have the static storage, as the generator refers to it.
+*/
+
+#ifndef STATIC_CODEGEN_H
+#define STATIC_CODEGEN_H
+
+#include <cstddef>
+#include <initializer_list>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+#include "ErrorClasses.h"
+
+namespace CodegenAPI
+{
+    //a function parameter as 'FunctionParam'
+    struct StaticParam
+    {
+        std::string_view keyname;
+        bool cnst = false;
+        int refpow = 0;
+    };
+
+    class StaticTypeInfo
+    {
+    public:
+        enum class Kind { Class, Struct, Function };
+        static constexpr std::size_t MaxTemplateParams = 8;
+        static constexpr std::size_t MaxParams = 16;
+    protected:
+        Kind m_kind;
+        //the module is kept as 'ModuleName' keeps it, without the brackets or the quotes
+        std::string_view m_module;
+        bool m_system;
+        std::string_view m_template_params[MaxTemplateParams] {};
+        std::size_t m_template_count;
+        StaticParam m_params[MaxParams] {};
+        std::size_t m_param_count;
+
+        constexpr StaticTypeInfo(Kind kind, std::string_view module,
+            std::initializer_list<std::string_view> template_params, std::initializer_list<StaticParam> params)
+            : m_kind(kind), m_module(module), m_system(), m_template_count(), m_param_count()
+        {
+            if(m_module.size()>=2)
+            {
+                if(m_module.front()=='<' && m_module.back()=='>')
+                    { m_system = true; m_module = m_module.substr(1,m_module.size()-2); }
+                else if(m_module.front()=='\"' && m_module.back()=='\"')
+                    m_module = m_module.substr(1,m_module.size()-2);
+            }
+
+            if(template_params.size()>MaxTemplateParams)throw std::length_error("too many template parameters");
+            if(params.size()>MaxParams)throw std::length_error("too many function parameters");
+            for(std::string_view param : template_params)m_template_params[m_template_count++] = param;
+            for(const StaticParam &param : params)m_params[m_param_count++] = param;
+        }
+    public:
+        constexpr Kind kind() const { return m_kind; }
+        constexpr std::string_view moduleName() const { return m_module; }
+        constexpr bool isSystemModule() const { return m_system; }
+        constexpr bool isExternal() const { return !m_module.empty(); }
+        constexpr bool isTemplate() const { return m_template_count>0; }
+
+        constexpr std::size_t templateParamCount() const { return m_template_count; }
+        constexpr std::string_view templateParam(std::size_t i) const { return m_template_params[i]; }
+        constexpr std::size_t paramCount() const { return m_param_count; }
+        constexpr const StaticParam& param(std::size_t i) const { return m_params[i]; }
+    };
+
+    class StaticClassInfo : public StaticTypeInfo
+    {
+    public:
+        constexpr StaticClassInfo(std::string_view module = "",
+            std::initializer_list<std::string_view> template_params = {})
+            : StaticTypeInfo(Kind::Class,module,template_params,{}) { }
+    };
+
+    class StaticStructInfo : public StaticTypeInfo
+    {
+    public:
+        constexpr StaticStructInfo(std::string_view module = "",
+            std::initializer_list<std::string_view> template_params = {})
+            : StaticTypeInfo(Kind::Struct,module,template_params,{}) { }
+    };
+
+    //the first parameter is the result, a function without parameters returns void
+    class StaticFunctionInfo : public StaticTypeInfo
+    {
+    public:
+        constexpr StaticFunctionInfo(std::string_view module = "", std::initializer_list<StaticParam> params = {})
+            : StaticTypeInfo(Kind::Function,module,{},params)
+            { if(m_param_count==0)m_params[m_param_count++] = StaticParam{"void"}; }
+    };
+
+    struct StaticEntry
+    {
+        std::string_view keyname;
+        StaticTypeInfo info;
+    };
+
+    class StaticNames
+    {
+    public:
+        static constexpr std::size_t MaxNames = 64;
+    protected:
+        std::string_view m_names[MaxNames] {};
+        std::size_t m_count;
+    public:
+        constexpr StaticNames(std::initializer_list<std::string_view> names = {}) : m_count()
+        {
+            if(names.size()>MaxNames)throw std::length_error("too many names");
+            for(std::string_view name : names)m_names[m_count++] = name;
+        }
+
+        constexpr std::size_t size() const { return m_count; }
+        constexpr std::string_view operator[](std::size_t i) const { return m_names[i]; }
+    };
+
+    struct StaticRequest
+    {
+        StaticNames include_names;
+        StaticNames declare_names;
+    };
+
+    enum class StaticStatus { Ok, DuplicateKey, NotFoundKey, SyntaxError, TemplateArguments, LoopForward, Overflow };
+
+    //the text of a header ended by zero
+    template <std::size_t Capacity> class StaticSource
+    {
+    protected:
+        char m_text[Capacity+1] {};
+        std::size_t m_size = 0;
+    public:
+        constexpr bool append(std::string_view text)
+        {
+            if(text.size()>Capacity-m_size)return false;
+            for(char ch : text)m_text[m_size++] = ch;
+            return true;
+        }
+        constexpr bool fill(char ch, std::size_t count)
+        {
+            if(count>Capacity-m_size)return false;
+            for(; count>0; --count)m_text[m_size++] = ch;
+            return true;
+        }
+
+        constexpr std::size_t size() const { return m_size; }
+        constexpr const char* c_str() const { return m_text; }
+        constexpr std::string_view view() const { return std::string_view(m_text,m_size); }
+        operator std::string() const { return std::string(m_text,m_size); }
+    };
+
+    template <std::size_t N> class StaticCodegen
+    {
+    protected:
+        //counts the size of the text without writing it
+        struct Counter
+        {
+            std::size_t size = 0;
+            constexpr bool append(std::string_view text) { size += text.size(); return true; }
+            constexpr bool fill(char, std::size_t count) { size += count; return true; }
+        };
+
+        //the generation state of the scheme entries
+        struct State
+        {
+            bool placed[N] {};
+            bool forced[N] {};
+            bool emitted[N] {};
+            std::size_t pending[N] {};
+            std::size_t emitted_count = 0;
+            bool force_endl = false;
+            std::string_view error_name {};
+        };
+
+        const StaticEntry *m_scheme;
+
+        static constexpr bool isFundamental(std::string_view name)
+        {
+            constexpr std::string_view fundamental[] =
+                {"void", "char", "int", "long", "long long", "unsigned", "size_t", "float", "double"};
+            for(std::string_view some : fundamental)if(some==name)return true;
+            return false;
+        }
+        constexpr std::size_t find(std::string_view name) const
+        {
+            for(std::size_t i=0; i<N; ++i)if(m_scheme[i].keyname==name)return i;
+            return N;
+        }
+        //the namespace of a key, the empty one for the global namespace, or the syntax error
+        static constexpr bool spaceOf(std::string_view name, std::string_view &space)
+        {
+            std::size_t offset = 0, pos = 0;
+            while((pos = name.find(':',offset))!=std::string_view::npos)
+            {
+                if(pos==offset || pos+1==name.size() || name[pos+1]!=':')return false;
+                offset = pos+2;
+            }
+            if(offset>=name.size())return false;
+            space = offset>0 ? name.substr(0,offset-2) : std::string_view();
+            return true;
+        }
+        //the dependency blocks the forward until it is declared, as 'Codegen' does
+        constexpr bool blocks(const State &state, std::size_t key, std::string_view depname) const
+        {
+            if(m_scheme[key].keyname==depname || isFundamental(depname))return false;
+            std::size_t dep = find(depname);
+            return state.placed[dep] && (state.forced[dep] || !m_scheme[dep].info.isExternal());
+        }
+        constexpr bool ready(const State &state, std::size_t i) const
+            { return state.placed[i] && !state.emitted[i] && state.pending[i]==0; }
+        static constexpr bool inside(std::string_view name, std::string_view space)
+        {
+            return space.empty() ||
+                (name.size()>space.size()+2 && name.substr(0,space.size())==space && name.substr(space.size(),2)=="::");
+        }
+        static constexpr bool moduleLess(const StaticTypeInfo &lhs, const StaticTypeInfo &rhs)
+        {
+            if(lhs.isSystemModule()!=rhs.isSystemModule())return lhs.isSystemModule();
+            return lhs.moduleName()<rhs.moduleName();
+        }
+
+        template <class Writer> static constexpr bool skip(State &state, Writer &writer, std::size_t depth)
+        {
+            if(state.force_endl){ state.force_endl = false; if(!writer.append("\n"))return false; }
+            return writer.fill('\t',depth);
+        }
+        template <class Writer> static constexpr bool writeParam(Writer &writer, const StaticParam &param,
+            std::string_view deepname)
+        {
+            std::string_view name = param.keyname;
+            if(deepname.size()>0 && deepname.size()<name.size() && name.substr(0,deepname.size())==deepname)
+                name = name.substr(deepname.size());
+            return (!param.cnst || writer.append("const ")) && writer.append(name) &&
+                writer.fill('*',static_cast<std::size_t>(param.refpow>0 ? param.refpow : 0));
+        }
+        template <class Writer> constexpr bool writeForward(State &state, Writer &writer, std::size_t key,
+            std::string_view space, std::size_t depth) const
+        {
+            const StaticTypeInfo &info = m_scheme[key].info;
+            std::size_t relative = space.empty() ? 0 : space.size()+2;
+            std::string_view name = m_scheme[key].keyname.substr(relative);
+            std::string_view deepname = m_scheme[key].keyname.substr(0,relative);
+            if(!skip(state,writer,depth))return false;
+            if(info.kind()==StaticTypeInfo::Kind::Function)
+            {
+                bool written = writer.append("using ") && writer.append(name) && writer.append(" = ") &&
+                    writeParam(writer,info.param(0),deepname) && writer.append(" (*)(");
+                for(std::size_t i=1; written && i<info.paramCount(); ++i)
+                    written = (i==1 || writer.append(", ")) && writeParam(writer,info.param(i),deepname);
+                return written && writer.append(");\n");
+            }
+            if(info.isTemplate())
+            {
+                bool written = writer.append("template <");
+                for(std::size_t i=0; written && i<info.templateParamCount(); ++i)
+                    written = (i==0 || writer.append(", ")) && writer.append("typename ") &&
+                        writer.append(info.templateParam(i));
+                if(!written || !writer.append("> "))return false;
+            }
+            return writer.append(info.kind()==StaticTypeInfo::Kind::Class ? "class " : "struct ") &&
+                writer.append(name) && writer.append(";\n");
+        }
+
+        template <class Writer> constexpr bool emit(State &state, Writer &writer, std::size_t key,
+            std::string_view space, std::size_t depth) const
+        {
+            if(!writeForward(state,writer,key,space,depth))return false;
+            state.emitted[key] = true; ++state.emitted_count;
+            for(std::size_t i=0; i<N; ++i)if(state.placed[i] && !state.emitted[i])
+            {
+                const StaticTypeInfo &info = m_scheme[i].info;
+                for(std::size_t k=0; k<info.paramCount(); ++k)
+                    if(info.param(k).keyname==m_scheme[key].keyname && blocks(state,i,info.param(k).keyname))
+                        --state.pending[i];
+            }
+            return true;
+        }
+
+        //renders the namespace as the scheduler of 'Codegen' does: the ready forwards of the namespace
+        //first in the name order, then the children with the ready forwards in the name order, while any is left
+        template <class Writer> constexpr bool renderNode(State &state, Writer &writer,
+            std::string_view space, std::size_t depth) const
+        {
+            for(;;)
+            {
+                bool any = false;
+                for(std::size_t i=0; i<N && !any; ++i)any = ready(state,i) && inside(m_scheme[i].keyname,space);
+                if(!any)return true;
+
+                for(;;)
+                {
+                    std::size_t next = N;
+                    for(std::size_t i=0; i<N; ++i)
+                    {
+                        std::string_view keyspace;
+                        if(ready(state,i) && spaceOf(m_scheme[i].keyname,keyspace) && keyspace==space &&
+                                (next==N || m_scheme[i].keyname<m_scheme[next].keyname))
+                            next = i;
+                    }
+                    if(next==N)break;
+                    if(!emit(state,writer,next,space,depth))return false;
+                }
+
+                std::string_view last {};
+                for(bool scanned = false;; scanned = true)
+                {
+                    std::string_view child {}, child_space {};
+                    std::size_t relative = space.empty() ? 0 : space.size()+2;
+                    for(std::size_t i=0; i<N; ++i)
+                    {
+                        std::string_view name = m_scheme[i].keyname, keyspace;
+                        if(!ready(state,i) || !spaceOf(name,keyspace) || keyspace.size()<=space.size() ||
+                                !inside(name,space))
+                            continue;
+                        std::string_view segment = name.substr(relative);
+                        segment = segment.substr(0,segment.find("::"));
+                        if((!scanned || last<segment) && (child_space.empty() || segment<child))
+                            { child = segment; child_space = name.substr(0,relative+segment.size()); }
+                    }
+                    if(child_space.empty())break;
+                    if(!skip(state,writer,depth) || !writer.append("namespace ") || !writer.append(child) ||
+                            !writer.append("\n") || !skip(state,writer,depth) || !writer.append("{\n"))
+                        return false;
+                    if(!renderNode(state,writer,child_space,depth+1))return false;
+                    if(!skip(state,writer,depth) || !writer.append("}\n"))return false;
+                    last = child;
+                }
+            }
+        }
+
+        template <class Writer> constexpr StaticStatus render(const StaticRequest &request, Writer &writer,
+            State &state) const
+        {
+            for(std::size_t i=0; i<N; ++i)
+                for(std::size_t k=0; k<i; ++k)
+                    if(m_scheme[k].keyname==m_scheme[i].keyname)
+                        { state.error_name = m_scheme[i].keyname; return StaticStatus::DuplicateKey; }
+
+            //the closure of the declared names
+            for(std::size_t j=0; j<request.declare_names.size(); ++j)
+            {
+                std::size_t key = find(request.declare_names[j]);
+                if(key==N){ state.error_name = request.declare_names[j]; return StaticStatus::NotFoundKey; }
+                state.placed[key] = state.forced[key] = true;
+            }
+            bool included[N] {};
+            for(bool grown = true; grown;)
+            {
+                grown = false;
+                for(std::size_t i=0; i<N; ++i)if(state.placed[i] && !included[i])
+                {
+                    included[i] = grown = true;
+                    const StaticTypeInfo &info = m_scheme[i].info;
+                    for(std::size_t k=0; k<info.paramCount(); ++k)
+                    {
+                        std::string_view depname = info.param(k).keyname;
+                        if(isFundamental(depname))continue;
+                        std::size_t dep = find(depname);
+                        if(dep==N){ state.error_name = depname; return StaticStatus::NotFoundKey; }
+                        if(m_scheme[dep].info.isTemplate())
+                            { state.error_name = m_scheme[i].keyname; return StaticStatus::TemplateArguments; }
+                        if(!m_scheme[dep].info.isExternal())state.placed[dep] = true;
+                    }
+                }
+            }
+
+            //the modules of the forwards, of their external dependencies and of the forced includes
+            bool modules[N] {};
+            for(std::size_t i=0; i<N; ++i)if(state.placed[i])
+            {
+                const StaticTypeInfo &info = m_scheme[i].info;
+                modules[i] = info.isExternal();
+                for(std::size_t k=0; k<info.paramCount(); ++k)
+                    if(std::string_view depname = info.param(k).keyname; !isFundamental(depname))
+                        modules[find(depname)] |= m_scheme[find(depname)].info.isExternal();
+            }
+            for(std::size_t j=0; j<request.include_names.size(); ++j)
+            {
+                std::size_t key = find(request.include_names[j]);
+                if(key==N){ state.error_name = request.include_names[j]; return StaticStatus::NotFoundKey; }
+                modules[key] |= m_scheme[key].info.isExternal();
+            }
+            for(std::size_t written = N;;)
+            {
+                std::size_t next = N;
+                for(std::size_t i=0; i<N; ++i)
+                    if(modules[i] && (written==N || moduleLess(m_scheme[written].info,m_scheme[i].info)) &&
+                            (next==N || moduleLess(m_scheme[i].info,m_scheme[next].info)))
+                        next = i;
+                if(next==N)break;
+                const StaticTypeInfo &info = m_scheme[next].info;
+                if(!writer.append("#include ") || !writer.append(info.isSystemModule() ? "<" : "\"") ||
+                        !writer.append(info.moduleName()) || !writer.append(info.isSystemModule() ? ">\n" : "\"\n"))
+                    return StaticStatus::Overflow;
+                state.force_endl = true;
+                written = next;
+            }
+
+            //the forwards wait for their dependencies
+            std::size_t placed_count = 0;
+            for(std::size_t i=0; i<N; ++i)if(state.placed[i])
+            {
+                std::string_view space;
+                if(!spaceOf(m_scheme[i].keyname,space))
+                    { state.error_name = m_scheme[i].keyname; return StaticStatus::SyntaxError; }
+                ++placed_count;
+                const StaticTypeInfo &info = m_scheme[i].info;
+                for(std::size_t k=0; k<info.paramCount(); ++k)
+                    if(blocks(state,i,info.param(k).keyname))++state.pending[i];
+            }
+            if(!renderNode(state,writer,std::string_view(),0))return StaticStatus::Overflow;
+            if(state.emitted_count<placed_count)return StaticStatus::LoopForward;
+            return StaticStatus::Ok;
+        }
+
+        static void raise(StaticStatus status, std::string_view name)
+        {
+            switch(status)
+            {
+            case StaticStatus::DuplicateKey: throw DuplicateKeyError(std::string(name));
+            case StaticStatus::NotFoundKey: throw NotFoundKeyError(std::string(name));
+            case StaticStatus::SyntaxError: throw SyntaxError();
+            case StaticStatus::TemplateArguments: throw std::runtime_error("template arguments are not supported");
+            case StaticStatus::LoopForward: throw LoopForwardError();
+            default: throw std::length_error("the text exceeds the capacity");
+            }
+        }
+    public:
+        constexpr StaticCodegen(const StaticEntry (&scheme)[N]) : m_scheme(scheme) { }
+
+        constexpr StaticStatus check(const StaticRequest &request) const
+            { Counter counter; State state; return render(request,counter,state); }
+        constexpr std::size_t sourceSize(const StaticRequest &request) const
+            { Counter counter; State state; render(request,counter,state); return counter.size; }
+        //throws the error of the generation, so a wrong scheme fails the compilation
+        template <std::size_t Capacity> constexpr StaticSource<Capacity> source(const StaticRequest &request) const
+        {
+            StaticSource<Capacity> text; State state;
+            if(StaticStatus status = render(request,text,state); status!=StaticStatus::Ok)
+                raise(status,state.error_name);
+            return text;
+        }
+    };
+}
+#endif
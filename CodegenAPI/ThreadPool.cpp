@@ -0,0 +1,50 @@
+/*
+file:   ThreadPool.cpp
+
+author:	Aleksey Yakovlev
+data:	October 16, 2026
+
+A fixed pool of worker threads for a task on the topic of code generation.
+*/
+
+#include "pch.h"
+#include "ThreadPool.h"
+
+using namespace CodegenAPI;
+using namespace std;
+
+
+
+ThreadPool::ThreadPool(unsigned threads) : m_stopped(false)
+{
+    if(threads==0)threads = max(1u,thread::hardware_concurrency());
+    for(unsigned i=0; i<threads; ++i)m_workers.emplace_back([this]() { work(); });
+}
+
+ThreadPool::~ThreadPool()
+{
+    { lock_guard<mutex> lock(m_mutex); m_stopped = true; }
+    m_ready.notify_all();
+    for(thread &worker : m_workers)worker.join();
+}
+
+void ThreadPool::submit(function<void()> task)
+{
+    { lock_guard<mutex> lock(m_mutex); m_tasks.push_back(move(task)); }
+    m_ready.notify_one();
+}
+
+void ThreadPool::work()
+{
+    for(;;)
+    {
+        function<void()> task;
+        {
+            unique_lock<mutex> lock(m_mutex);
+            m_ready.wait(lock,[this]() { return m_stopped || !m_tasks.empty(); });
+            if(m_tasks.empty())return;
+            task = move(m_tasks.front()); m_tasks.pop_front();
+        }
+        task();
+    }
+}
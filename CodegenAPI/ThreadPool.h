@@ -0,0 +1,86 @@
+/*
+file:   ThreadPool.h
+
+author:	Aleksey Yakovlev
+data:	October 16, 2026
+
+A fixed pool of worker threads for a task on the topic of code generation.
+*/
+
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace CodegenAPI
+{
+    class ThreadPool
+    {
+    protected:
+        std::vector<std::thread> m_workers;
+        std::deque<std::function<void()>> m_tasks;
+        std::mutex m_mutex;
+        std::condition_variable m_ready;
+        bool m_stopped;
+
+        void work();
+    public:
+        //zero threads means one thread per hardware core
+        explicit ThreadPool(unsigned threads = 0);
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+        ~ThreadPool();
+
+        std::size_t size() const { return m_workers.size(); }
+        void submit(std::function<void()> task);
+
+        //calls 'func(i)' for every 'i' below 'count' on the workers and the calling thread,
+        //returns when all calls are done and rethrows the first exception of them;
+        //it must not be called from a task of the same pool
+        template <class Func> void parallelFor(std::size_t count, Func func)
+        {
+            struct State
+            {
+                std::atomic<std::size_t> next {0};
+                std::mutex mutex;
+                std::condition_variable done;
+                std::size_t active {0};
+                std::exception_ptr error;
+            };
+            auto state = std::make_shared<State>();
+            auto loop = [state,&func,count]()
+            {
+                for(std::size_t i; (i = state->next++)<count;)
+                    try { func(i); }
+                    catch(...)
+                    {
+                        std::lock_guard<std::mutex> lock(state->mutex);
+                        if(!state->error)state->error = std::current_exception();
+                    }
+            };
+
+            std::size_t helpers = count>1 ? std::min(m_workers.size(),count-1) : 0;
+            state->active = helpers;
+            for(std::size_t i=0; i<helpers; ++i)submit([state,loop]()
+            {
+                loop();
+                std::lock_guard<std::mutex> lock(state->mutex);
+                if(--state->active==0)state->done.notify_all();
+            });
+            loop();
+
+            std::unique_lock<std::mutex> lock(state->mutex);
+            state->done.wait(lock,[&state]() { return state->active==0; });
+            if(state->error)std::rethrow_exception(state->error);
+        }
+    };
+}
+#endif
@@ -9,75 +9,212 @@ Description of data types for a task on the topic of code generation.
 
 #include "pch.h"
 #include "TypeInfo.h"
+#include "OutputSink.h"
+#include "SchemeArena.h"
+
+#include <cstring>
 
 using namespace CodegenAPI;
 using namespace std;
 
 
 
+static char* put(char *text, string_view part)
+{
+    memcpy(text,part.data(),part.size()); return text+part.size();
+}
+
+
+
 string FunctionParam::view() const 
 {
-    stringstream ss; ss<<m_keyname;
-    for(int i=0;i<m_refpow;++i)ss<<"*"; return ss.str();
+    string text; text.reserve(m_keyname->size()+max(m_refpow,0));
+    text.append(*m_keyname).append(max(m_refpow,0),'*'); return text;
 }
 
 string FunctionParam::view(const string &deepname) const
 {
-    stringstream ss;
-    if(m_const)ss<<"const ";
-    if(deepname.size()>0 && deepname.size()<m_keyname.size() && 
-        m_keyname.substr(0,deepname.size())==deepname)
-        ss<<m_keyname.substr(deepname.size(),m_keyname.size()-deepname.size());
-    else ss<<m_keyname;
-    for(int i=0;i<m_refpow;++i)ss<<"*"; return ss.str();
+    BufferSink sink; view(sink,deepname); return sink.release();
+}
+
+void FunctionParam::view(OutputSink &sink, const string &deepname) const
+{
+    const LongName &keyname = *m_keyname;
+    if(m_const)sink<<"const ";
+    if(deepname.size()>0 && deepname.size()<keyname.size() && 
+        keyname.compare(0,deepname.size(),deepname)==0)
+        sink<<string_view(keyname).substr(deepname.size());
+    else sink<<keyname;
+    sink.fill('*',static_cast<size_t>(max(m_refpow,0)));
+}
+
+size_t FunctionParam::viewSize(string_view deepname) const
+{
+    const LongName &keyname = *m_keyname;
+    size_t size = m_const ? 6 : 0;
+    if(deepname.size()>0 && deepname.size()<keyname.size() &&
+        keyname.compare(0,deepname.size(),deepname)==0)
+        size += keyname.size()-deepname.size();
+    else size += keyname.size();
+    return size+max(m_refpow,0);
+}
+
+char* FunctionParam::view(char *text, string_view deepname) const
+{
+    const LongName &keyname = *m_keyname;
+    if(m_const)text = put(text,"const ");
+    if(deepname.size()>0 && deepname.size()<keyname.size() &&
+        keyname.compare(0,deepname.size(),deepname)==0)
+        text = put(text,string_view(keyname).substr(deepname.size()));
+    else text = put(text,keyname);
+    if(m_refpow>0){ memset(text,'*',m_refpow); text += m_refpow; }
+    return text;
 }
 
 
 
-ModuleName::ModuleName(string name) : m_name(name), m_system()
+ModuleName::ModuleName(string name) : m_name(move(name)), m_system()
 {
-    if(m_name.size()>=2)
-        if(m_name[0]=='<' && m_name[m_name.size()-1]=='>')
-            { m_system = true; m_name = m_name.substr(1,m_name.size()-2); }
+    if(m_name.size()>=2 && m_name[0]=='<' && m_name[m_name.size()-1]=='>')
+        { m_system = true; m_name.pop_back(); m_name.erase(0,1); }
         else if(m_name[0]=='\"' && m_name[m_name.size()-1]=='\"')
-            m_name = m_name.substr(1,m_name.size()-2);
+            { m_name.pop_back(); m_name.erase(0,1); }
 }
 string ModuleName::view() const
     { return m_system ? "<"+m_name+">" : "\""+m_name+"\""; }
 
 
 
+TypeInfo::TypeInfo(const char module[], initializer_list<TemplateParam> template_params,
+    const allocator_type &alloc) : m_module(module), m_template_params(alloc)
+{
+    m_template_params.reserve(template_params.size());
+    for(const TemplateParam &param : template_params)m_template_params.emplace_back(param);
+}
+
+TypeInfo::TypeInfo(string_view module, Span<string_view> template_params,
+    const allocator_type &alloc) 
+    : m_module(string(module)), m_template_params(template_params.begin(),template_params.end(),alloc)
+{
+}
+
 stringstream& TypeInfo::translateTemplateParams(stringstream &ss) const
+{
+    StreamSink sink(ss); translateTemplateParams(sink); return ss;
+};
+
+OutputSink& TypeInfo::translateTemplateParams(OutputSink &sink) const
 {
     if(isTemplate())
     {
-        ss<<"template <";
+        sink<<"template <";
         for(size_t i=0;i+1<m_template_params.size();++i)
-            ss<<"typename "<<m_template_params[i]<<", ";
-        ss<<"typename "<<m_template_params[m_template_params.size()-1]<<"> ";
+            sink<<"typename "<<m_template_params[i]<<", ";
+        sink<<"typename "<<m_template_params[m_template_params.size()-1]<<"> ";
     }
-    return ss;
+    return sink;
 };
 
+size_t TypeInfo::templateParamsSize() const
+{
+    //"template <" and "> ", "typename " and ", " between the parameters
+    if(!isTemplate())return 0;
+    size_t size = 12+11*m_template_params.size()-2;
+    for(const auto &param : m_template_params)size += param.size();
+    return size;
+}
+
+char* TypeInfo::translateTemplateParams(char *text) const
+{
+    if(!isTemplate())return text;
+    text = put(text,"template <");
+    for(size_t i=0;i<m_template_params.size();++i)
+        text = put(put(text,i==0 ? "typename " : ", typename "),m_template_params[i]);
+    return put(text,"> ");
+}
+
+void TypeInfo::translate(OutputSink &sink,
+        const string &key, const string &name) const
+{
+    stringstream ss; translate(ss,key,name); sink<<ss.str();
+}
+
+size_t TypeInfo::translatedSize(string_view key, string_view name) const
+{
+    BufferSink sink; translate(sink,string(key),string(name)); return sink.view().size();
+}
+
+char* TypeInfo::translate(char *text, string_view key, string_view name) const
+{
+    BufferSink sink; translate(sink,string(key),string(name)); return put(text,sink.view());
+}
+
 
 
+TypeInfo* ClassTypeInfo::make(SchemeArena &arena, const char module[],
+    initializer_list<TemplateParam> template_params)
+{
+    return arena.make<ClassTypeInfo>(module,template_params);
+}
+
 void ClassTypeInfo::translate(stringstream &ss,
         const string &key, const string &name) const
 { 
-    translateTemplateParams(ss)<<"class "<<name<<";"<<endl; 
+    StreamSink sink(ss); translate(sink,key,name);
+}
+
+void ClassTypeInfo::translate(OutputSink &sink,
+        const string &, const string &name) const
+{ 
+    translateTemplateParams(sink)<<"class "<<name<<";\n"; 
 }
 
+char* ClassTypeInfo::translate(char *text, string_view, string_view name) const
+{
+    return put(put(put(translateTemplateParams(text),"class "),name),";\n");
+}
+
+
 
+TypeInfo* StructTypeInfo::make(SchemeArena &arena, const char module[],
+    initializer_list<TemplateParam> template_params)
+{
+    return arena.make<StructTypeInfo>(module,template_params);
+}
 
 void StructTypeInfo::translate(stringstream &ss,
         const string &key, const string &name) const
 { 
-    translateTemplateParams(ss)<<"struct "<<name<<";"<<endl; 
+    StreamSink sink(ss); translate(sink,key,name);
+}
+
+void StructTypeInfo::translate(OutputSink &sink,
+        const string &, const string &name) const
+{ 
+    translateTemplateParams(sink)<<"struct "<<name<<";\n"; 
+}
+
+char* StructTypeInfo::translate(char *text, string_view, string_view name) const
+{
+    return put(put(put(translateTemplateParams(text),"struct "),name),";\n");
 }
 
 
 
-void FunctionTypeInfo::check(const LongName &keyname,
+TypeInfo* FunctionTypeInfo::make(SchemeArena &arena, const char module[],
+    initializer_list<FunctionParam> params)
+{
+    //the names of the parameters are kept by the arena
+    vector<FunctionParamView> views; views.reserve(params.size());
+    for(const FunctionParam &param : params)
+    {
+        const LongName &kept = arena.intern(param.getKeyName());
+        views.push_back({kept,param.isConst(),param.getRefPow(),&kept});
+    }
+    return arena.make<FunctionTypeInfo>(string_view(module),Span<FunctionParamView>(views.data(),views.data()+views.size()));
+}
+
+void FunctionTypeInfo::check(const LongName &,
     const map<LongName,shared_ptr<TypeInfo>> &scheme) const
 { 
     for(const FunctionParam &param : m_params)
@@ -86,19 +223,49 @@ void FunctionTypeInfo::check(const LongName &keyname,
             throw runtime_error("template arguments are not supported");
 }
 
+void FunctionTypeInfo::check(string_view, const TypeLookup &lookup) const
+{
+    for(const FunctionParam &param : m_params)
+        if(const TypeInfo *info = lookup.find(param.getKeyNameView()); info && info->isTemplate())
+            throw runtime_error("template arguments are not supported");
+}
+
 vector<LongName> FunctionTypeInfo::dependencies() const
 {
     vector<LongName> deps;
     for_each(begin(m_params),end(m_params),
-        [&deps](const FunctionParam &param) {deps.push_back(param.getKeyName());});
+        [&deps](const FunctionParam &param) {deps.emplace_back(param.getKeyName());});
     return deps;
 }
 
 void FunctionTypeInfo::translate(stringstream &ss, 
     const string &key, const string &name) const
 {
-    ss<<"using "<<name<<" = "<<m_params[0].view(key)<<" (*)(";
-    for(size_t i=1; i+1<m_params.size(); ++i)ss<<m_params[i].view(key)<<", ";
-    if(m_params.size()>1)ss<<m_params[m_params.size()-1].view(key);
-    ss<<")"<<";"<<endl;
-}
\ No newline at end of file
+    StreamSink sink(ss); translate(sink,key,name);
+}
+
+size_t FunctionTypeInfo::translatedSize(string_view key, string_view name) const
+{
+    //"using ", " = ", " (*)(", ", " between the parameters and ");\n"
+    size_t size = 6+name.size()+3+5+3;
+    for(size_t i=0; i<m_params.size(); ++i)size += m_params[i].viewSize(key);
+    if(m_params.size()>2)size += 2*(m_params.size()-2);
+    return size;
+}
+
+void FunctionTypeInfo::translate(OutputSink &sink, 
+    const string &key, const string &name) const
+{
+    sink<<"using "<<name<<" = "; m_params[0].view(sink,key); sink<<" (*)(";
+    for(size_t i=1; i+1<m_params.size(); ++i){ m_params[i].view(sink,key); sink<<", "; }
+    if(m_params.size()>1)m_params[m_params.size()-1].view(sink,key);
+    sink<<");\n";
+}
+
+char* FunctionTypeInfo::translate(char *text, string_view key, string_view name) const
+{
+    text = m_params[0].view(put(put(put(text,"using "),name)," = "),key); text = put(text," (*)(");
+    for(size_t i=1; i+1<m_params.size(); ++i)text = put(m_params[i].view(text,key),", ");
+    if(m_params.size()>1)text = m_params[m_params.size()-1].view(text,key);
+    return put(text,");\n");
+}
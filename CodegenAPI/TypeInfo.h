@@ -14,11 +14,18 @@ Description of data types for a task on the topic of code generation.
 #include <map>
 #include <set>
 #include <sstream>
+#include <memory_resource>
+#include <string_view>
 
 #include "ErrorClasses.h"
+#include "NameTable.h"
 
 namespace CodegenAPI
 {
+    class OutputSink;
+    class SchemeArena;
+    class Snapshot;
+
     using LongName = std::string;
 
     using TemplateParam = std::string;
@@ -40,24 +47,58 @@ namespace CodegenAPI
             { return m_system && !module.m_system || m_system==module.m_system && m_name.compare(module.m_name)<0; }
     };
 
+    class TypeInfo;
+
+    //the types of a scheme by their names for the checks of the types
+    class TypeLookup
+    {
+    public:
+        virtual ~TypeLookup() = default;
+
+        //the type of the key or null when there is no such key
+        virtual const TypeInfo* find(std::string_view keyname) const =0;
+        //the ordered scheme, which is built by the first call
+        virtual const std::map<LongName,std::shared_ptr<TypeInfo>>& scheme() const =0;
+    };
+
     class TypeInfo
     {
+    public:
+        using allocator_type = std::pmr::polymorphic_allocator<std::byte>;
     protected:
         ModuleName m_module;
-        std::vector<TemplateParam> m_template_params;
+        std::pmr::vector<std::pmr::string> m_template_params;
         std::stringstream& translateTemplateParams(std::stringstream &ss) const;
-        TypeInfo(const char module[], std::initializer_list<TemplateParam> template_params)
-            : m_module(module), m_template_params(template_params) {}
+        OutputSink& translateTemplateParams(OutputSink &sink) const;
+        std::size_t templateParamsSize() const;
+        char* translateTemplateParams(char *text) const;
+        TypeInfo(const char module[], std::initializer_list<TemplateParam> template_params,
+            const allocator_type &alloc = {});
+        TypeInfo(std::string_view module, Span<std::string_view> template_params,
+            const allocator_type &alloc = {});
     public:
+        virtual ~TypeInfo() = default;
+
         const ModuleName& getModule() const { return m_module; }
+        const std::pmr::vector<std::pmr::string>& getTemplateParams() const { return m_template_params; }
 
         virtual void check(const LongName &keyname,
             const std::map<LongName,std::shared_ptr<TypeInfo>> &scheme) const { }
+        //a kind without its own check by the lookups is checked over the ordered scheme
+        virtual void check(std::string_view keyname, const TypeLookup &lookup) const
+            { check(LongName(keyname),lookup.scheme()); }
 
         virtual std::vector<LongName> dependencies() const =0;
 
         virtual void translate(std::stringstream &ss,
             const std::string &key, const std::string &name) const =0;
+        virtual void translate(OutputSink &sink,
+            const std::string &key, const std::string &name) const;
+        //the exact length of the text 'translate' writes, so the text is written into one buffer;
+        //a kind without its own count is translated once to be measured
+        virtual std::size_t translatedSize(std::string_view key, std::string_view name) const;
+        //writes the 'translatedSize' bytes of the text in place and returns the end of them
+        virtual char* translate(char *text, std::string_view key, std::string_view name) const;
 
         bool isTemplate() const { return !m_template_params.empty(); }
         bool isExternal() const { return m_module.isPerfect(); }
@@ -67,74 +108,148 @@ namespace CodegenAPI
     {
     public:
         ClassTypeInfo(const char module[],
-            std::initializer_list<TemplateParam> template_params = {}) 
-            : TypeInfo(module,template_params) {}
+            std::initializer_list<TemplateParam> template_params = {},
+            const allocator_type &alloc = {}) 
+            : TypeInfo(module,template_params,alloc) {}
+        ClassTypeInfo(std::string_view module, Span<std::string_view> template_params,
+            const allocator_type &alloc = {}) 
+            : TypeInfo(module,template_params,alloc) {}
 
+        //nothing to check, the ordered scheme is not asked for
+        void check(std::string_view, const TypeLookup &) const override { }
         std::vector<LongName> dependencies() const override 
             { return std::vector<LongName>(); }
 
+        using TypeInfo::translate;
         void translate(std::stringstream &ss,
             const std::string &key, const std::string &name) const override;
+        void translate(OutputSink &sink,
+            const std::string &key, const std::string &name) const override;
+        std::size_t translatedSize(std::string_view, std::string_view name) const override
+            { return templateParamsSize()+8+name.size(); }
+        char* translate(char *text, std::string_view, std::string_view name) const override;
 
         static std::shared_ptr<TypeInfo> make(const char module[],
             std::initializer_list<TemplateParam> template_params = {})
             { return std::static_pointer_cast<TypeInfo>(std::make_shared<ClassTypeInfo>(module,template_params)); }
+        static TypeInfo* make(SchemeArena &arena, const char module[],
+            std::initializer_list<TemplateParam> template_params = {});
     };
 
     class StructTypeInfo : public TypeInfo
     {
     public:
         StructTypeInfo(const char module[],
-            std::initializer_list<TemplateParam> template_params = {}) 
-            : TypeInfo(module,template_params) {}
+            std::initializer_list<TemplateParam> template_params = {},
+            const allocator_type &alloc = {}) 
+            : TypeInfo(module,template_params,alloc) {}
+        StructTypeInfo(std::string_view module, Span<std::string_view> template_params,
+            const allocator_type &alloc = {}) 
+            : TypeInfo(module,template_params,alloc) {}
 
+        //nothing to check, the ordered scheme is not asked for
+        void check(std::string_view, const TypeLookup &) const override { }
         std::vector<LongName> dependencies() const override 
             { return std::vector<LongName>(); }
 
+        using TypeInfo::translate;
         void translate(std::stringstream &ss,
             const std::string &key, const std::string &name) const override;
+        void translate(OutputSink &sink,
+            const std::string &key, const std::string &name) const override;
+        std::size_t translatedSize(std::string_view, std::string_view name) const override
+            { return templateParamsSize()+9+name.size(); }
+        char* translate(char *text, std::string_view, std::string_view name) const override;
 
         static std::shared_ptr<TypeInfo> make(const char module[],
             std::initializer_list<TemplateParam> template_params = {})
             { return std::static_pointer_cast<TypeInfo>(std::make_shared<StructTypeInfo>(module,template_params)); }
+        static TypeInfo* make(SchemeArena &arena, const char module[],
+            std::initializer_list<TemplateParam> template_params = {});
+    };
+
+    //a function parameter referring to the text it is read from; the name kept by the arena
+    //or the snapshot of the type is referred to by the parameter, the text is copied otherwise
+    struct FunctionParamView
+    {
+        std::string_view keyname;
+        bool cnst;
+        int refpow;
+        const LongName *kept = nullptr;
     };
 
     class FunctionParam
     {
     protected:
-        LongName m_keyname;
+        //the name of a parameter made alone, a kept name is only referred to
+        LongName m_own;
+        const LongName *m_keyname;
         bool m_const;
         int m_refpow;
+
+        bool ownsName() const { return m_keyname==&m_own; }
     public:
         FunctionParam(const LongName &keyname, bool cnst = false, int refpow = 0)
-            : m_keyname(keyname), m_const(cnst), m_refpow(refpow) {}
+            : m_own(keyname), m_keyname(&m_own), m_const(cnst), m_refpow(refpow) {}
+        FunctionParam(const FunctionParamView &param)
+            : m_own(param.kept ? std::string_view() : param.keyname), m_keyname(param.kept ? param.kept : &m_own),
+            m_const(param.cnst), m_refpow(param.refpow) {}
+        FunctionParam(const FunctionParam &param)
+            : m_own(param.m_own), m_keyname(param.ownsName() ? &m_own : param.m_keyname),
+            m_const(param.m_const), m_refpow(param.m_refpow) {}
+        FunctionParam& operator=(const FunctionParam &param)
+        {
+            m_own = param.m_own; m_keyname = param.ownsName() ? &m_own : param.m_keyname;
+            m_const = param.m_const; m_refpow = param.m_refpow;
+            return *this;
+        }
 
-        const LongName& getKeyName() const { return m_keyname; }
+        const LongName& getKeyName() const { return *m_keyname; }
+        std::string_view getKeyNameView() const { return *m_keyname; }
+        bool isConst() const { return m_const; }
+        int getRefPow() const { return m_refpow; }
         std::string view() const;
         std::string view(const std::string &deepname) const;
+        void view(OutputSink &sink, const std::string &deepname) const;
+        std::size_t viewSize(std::string_view deepname) const;
+        char* view(char *text, std::string_view deepname) const;
     };
 
     class FunctionTypeInfo : public TypeInfo
     {
     protected:
-        std::vector<FunctionParam> m_params;
+        std::pmr::vector<FunctionParam> m_params;
     public:
         FunctionTypeInfo(const char module[],
-            std::initializer_list<FunctionParam> params = {}) 
-            : TypeInfo(module,{}), m_params(params)
+            std::initializer_list<FunctionParam> params = {},
+            const allocator_type &alloc = {}) 
+            : TypeInfo(module,{},alloc), m_params(params,alloc)
+            { if(m_params.empty())m_params.push_back({"void"}); }
+        FunctionTypeInfo(std::string_view module, Span<FunctionParamView> params,
+            const allocator_type &alloc = {}) 
+            : TypeInfo(module,{},alloc), m_params(params.begin(),params.end(),alloc)
             { if(m_params.empty())m_params.push_back({"void"}); }
 
         void check(const LongName &keyname,
             const std::map<LongName,std::shared_ptr<TypeInfo>> &scheme) const override;
+        void check(std::string_view keyname, const TypeLookup &lookup) const override;
 
         std::vector<LongName> dependencies() const override;
+        const std::pmr::vector<FunctionParam>& getParams() const { return m_params; }
 
+        using TypeInfo::translate;
         void translate(std::stringstream &ss, 
             const std::string &key, const std::string &name) const override;
+        void translate(OutputSink &sink,
+            const std::string &key, const std::string &name) const override;
+        std::size_t translatedSize(std::string_view key, std::string_view name) const override;
+        char* translate(char *text, std::string_view key, std::string_view name) const override;
 
         static std::shared_ptr<TypeInfo> make(const char module[],
             std::initializer_list<FunctionParam> params = {})
             { return std::static_pointer_cast<TypeInfo>(std::make_shared<FunctionTypeInfo>(module,params)); }
+        static TypeInfo* make(SchemeArena &arena, const char module[],
+            std::initializer_list<FunctionParam> params = {});
     };
 }
 #endif
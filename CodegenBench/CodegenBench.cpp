@@ -0,0 +1,185 @@
+/*
+file:   CodegenBench.cpp
+
+author:	Aleksey Yakovlev
+data:	October 16, 2026
+
+Benchmarks for a task on the topic of code generation.
+
+Every size of the synthetic scheme is measured by phases: the construction
+of 'Codegen', 'Codegen::code' for the first and for a repeated request,
+'Codegen::source' for the repeated request, 'IntermediateCode::verify' and
+'IntermediateCode::translate'. Each phase reports its time together with
+the count and the volume of the heap allocations made during it, which are
+counted by the replaced global allocation functions.
+*/
+
+#include "pch.h"
+#include "SchemeGenerator.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <new>
+#include <sstream>
+
+using namespace CodegenAPI;
+using namespace CodegenBench;
+using namespace std;
+
+static atomic<size_t> allocationCount{0}, allocationBytes{0};
+
+//the replaced allocation functions pair 'malloc' with 'free' themselves
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+void* operator new(size_t size)
+{
+    allocationCount.fetch_add(1,memory_order_relaxed); allocationBytes.fetch_add(size,memory_order_relaxed);
+    if(void *memory = malloc(size ? size : 1))return memory;
+    throw bad_alloc();
+}
+void* operator new(size_t size, align_val_t align)
+{
+    allocationCount.fetch_add(1,memory_order_relaxed); allocationBytes.fetch_add(size,memory_order_relaxed);
+    size_t alignment = static_cast<size_t>(align);
+#ifdef _WIN32
+    if(void *memory = _aligned_malloc(size ? size : 1,alignment))return memory;
+#else
+    if(void *memory = aligned_alloc(alignment,(size+alignment-1)/alignment*alignment))return memory;
+#endif
+    throw bad_alloc();
+}
+void operator delete(void *memory) noexcept { free(memory); }
+void operator delete(void *memory, size_t) noexcept { free(memory); }
+#ifdef _WIN32
+void operator delete(void *memory, align_val_t) noexcept { _aligned_free(memory); }
+void operator delete(void *memory, size_t, align_val_t) noexcept { _aligned_free(memory); }
+#else
+void operator delete(void *memory, align_val_t) noexcept { free(memory); }
+void operator delete(void *memory, size_t, align_val_t) noexcept { free(memory); }
+#endif
+
+//the time and the allocations of one phase
+class PhaseMeter
+{
+protected:
+    chrono::steady_clock::time_point m_start;
+    size_t m_count, m_bytes;
+public:
+    PhaseMeter() : m_start(chrono::steady_clock::now()),
+        m_count(allocationCount.load()), m_bytes(allocationBytes.load()) { }
+
+    void report(size_t types, const string &phase, const string &status = "ok") const
+    {
+        double ms = chrono::duration<double,milli>(chrono::steady_clock::now()-m_start).count();
+        cout<<setw(9)<<types<<"  "<<left<<setw(14)<<phase<<right
+            <<setw(12)<<fixed<<setprecision(2)<<ms<<" ms"
+            <<setw(12)<<allocationCount.load()-m_count<<" allocs"
+            <<setw(10)<<setprecision(1)<<(allocationBytes.load()-m_bytes)/1048576.0<<" MB"
+            <<"  "<<status<<endl;
+    }
+};
+
+static void usage()
+{
+    cout<<"usage: CodegenBench [options]\n"
+        <<"  --sizes N,N,...    numbers of types (1000,10000,100000,1000000)\n"
+        <<"  --depth N          namespace depth (3)\n"
+        <<"  --fanout N         namespaces per namespace (4)\n"
+        <<"  --params MIN:MAX   function parameters (1:4)\n"
+        <<"  --chain N          length of the function chains (8)\n"
+        <<"  --functions R      share of the functions (0.5)\n"
+        <<"  --cycles R         share of the chains closed into a loop (0)\n"
+        <<"  --external R       share of the external types (0.1)\n"
+        <<"  --declare N        declared names per request (100)\n"
+        <<"  --seed N           random seed (1)\n";
+}
+
+static void measure(const SchemeShape &shape, size_t declare)
+{
+    SchemeGenerator generator(shape);
+    auto scheme = generator.scheme();
+    vector<LongName> roots = generator.roots(declare);
+
+    PhaseMeter construction;
+    Codegen hg(move(scheme));
+    construction.report(shape.types,"construction");
+
+    IntermediateCode icode;
+    PhaseMeter code;
+    try { icode = hg.code({},roots); }
+    catch(const LoopForwardError&) { code.report(shape.types,"code","loop"); return; }
+    code.report(shape.types,"code");
+
+    //the closures and the namespace index are kept by the generator for the repeated requests
+    PhaseMeter repeat;
+    icode = hg.code({},roots);
+    repeat.report(shape.types,"code again");
+
+    //the text of a repeated request is written in place and returned in one allocation
+    PhaseMeter source;
+    string text = hg.source({},roots);
+    source.report(shape.types,"source",to_string(text.size())+" bytes");
+
+    PhaseMeter verify;
+    bool verified = icode.verify(hg.getSheme(),{},roots,SchemeGenerator::applied());
+    verify.report(shape.types,"verify",verified ? "ok" : "failed");
+
+    BufferSink sink;
+    PhaseMeter translate;
+    icode.translate(sink,hg.getSheme());
+    translate.report(shape.types,"translate",to_string(sink.view().size())+" bytes");
+}
+
+int main(int argc, char *argv[])
+{
+    int retcode;
+
+    try
+    {
+        SchemeShape shape;
+        vector<size_t> sizes{1000, 10000, 100000, 1000000};
+        size_t declare = 100;
+        for(int i = 1; i<argc; ++i)
+        {
+            string option = argv[i];
+            if(option=="--help"){ usage(); return 0; }
+            if(i+1>=argc)throw invalid_argument("missing value of "+option);
+            string value = argv[++i];
+            if(option=="--sizes")
+            {
+                sizes.clear(); stringstream list(value);
+                for(string size; getline(list,size,',');)sizes.push_back(stoul(size));
+            }
+            else if(option=="--depth")shape.namespace_depth = stoul(value);
+            else if(option=="--fanout")shape.namespace_fanout = stoul(value);
+            else if(option=="--params")
+            {
+                size_t colon = value.find(':');
+                shape.min_params = stoul(value.substr(0,colon));
+                shape.max_params = colon==string::npos ? shape.min_params : stoul(value.substr(colon+1));
+                if(shape.max_params<shape.min_params)throw invalid_argument("empty parameter range");
+            }
+            else if(option=="--chain")shape.chain_length = stoul(value);
+            else if(option=="--functions")shape.function_ratio = stod(value);
+            else if(option=="--cycles")shape.cycle_ratio = stod(value);
+            else if(option=="--external")shape.external_ratio = stod(value);
+            else if(option=="--declare")declare = stoul(value);
+            else if(option=="--seed")shape.seed = static_cast<uint32_t>(stoul(value));
+            else throw invalid_argument("unknown option "+option);
+        }
+
+        cout<<setw(9)<<"types"<<"  "<<left<<setw(14)<<"phase"<<right<<setw(15)<<"time"
+            <<setw(19)<<"allocations"<<setw(13)<<"volume"<<endl;
+        for(size_t size : sizes){ shape.types = size; measure(shape,declare); }
+
+        retcode = 0;
+    }
+    catch(const exception &ex) { cerr << ex.what() << endl; retcode=-1; }
+    catch(...) { cerr << "Unknown error"; retcode=-1; }
+
+    return retcode;
+}
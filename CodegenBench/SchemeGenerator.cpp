@@ -0,0 +1,114 @@
+/*
+file:   SchemeGenerator.cpp
+
+author:	Aleksey Yakovlev
+data:	October 16, 2026
+
+Generator of synthetic schemes for the benchmarks of a task on the topic
+of code generation.
+*/
+
+#include "pch.h"
+#include "SchemeGenerator.h"
+
+using namespace CodegenAPI;
+using namespace CodegenBench;
+using namespace std;
+
+
+
+SchemeGenerator::SchemeGenerator(const SchemeShape &shape) : m_shape(shape), m_random(shape.seed)
+{
+    //the namespaces of every level, the types are placed at any level but the global one
+    vector<string> level{string()};
+    for(size_t depth = 0; depth<m_shape.namespace_depth; ++depth)
+    {
+        vector<string> next;
+        for(const string &space : level)
+            for(size_t i = 0; i<max<size_t>(m_shape.namespace_fanout,1); ++i)
+                next.push_back(space+(space.empty() ? "" : "::")+"ns"+to_string(depth)+"_"+to_string(i));
+        m_spaces.insert(end(m_spaces),begin(next),end(next));
+        level.swap(next);
+    }
+    if(m_spaces.empty())m_spaces.push_back(string());
+
+    m_names.reserve(m_shape.types); m_functions.reserve(m_shape.types);
+    for(size_t i = 0; i<m_shape.types; ++i)
+    {
+        bool function = chance(m_shape.function_ratio);
+        const string &space = m_spaces[pick(m_spaces.size())];
+        m_names.push_back((space.empty() ? "" : space+"::")+(function ? "f" : "t")+to_string(i));
+        m_functions.push_back(function);
+    }
+}
+
+const set<LongName>& SchemeGenerator::applied()
+{
+    static const set<LongName> names{"void", "int"};
+    return names;
+}
+
+map<LongName,shared_ptr<TypeInfo>> SchemeGenerator::scheme()
+{
+    map<LongName,shared_ptr<TypeInfo>> scheme;
+    vector<size_t> chain;
+    auto module = [this](bool system)
+    {
+        string name = "lib"+to_string(pick(16));
+        return system ? "<"+name+">" : name+".h";
+    };
+
+    for(size_t i = 0; i<m_names.size(); ++i)
+    {
+        if(!m_functions[i])
+        {
+            string from = chance(m_shape.external_ratio) ? module(i%2==0) : string();
+            if(i%2==0)scheme.emplace(m_names[i],ClassTypeInfo::make(from.c_str()));
+            else scheme.emplace(m_names[i],StructTypeInfo::make(from.c_str()));
+            continue;
+        }
+
+        //the first parameter of a chained function is the previous function of its chain
+        vector<FunctionParamView> params{{"void",false,1}};
+        size_t count = m_shape.min_params+pick(m_shape.max_params-m_shape.min_params+1);
+        if(!chain.empty())params.push_back({m_names[chain.back()],false,0});
+        while(params.size()<count+1)
+        {
+            //the parameters refer to the earlier types, so only the injected loops close a cycle
+            size_t depname = i>0 ? pick(i) : 0;
+            params.push_back({i==0 || depname%8==0 ? string_view("int") : string_view(m_names[depname]),
+                chance(0.3),static_cast<int>(pick(3))});
+        }
+        string from = chance(m_shape.external_ratio) ? module(false) : string();
+        scheme.emplace(m_names[i],make_shared<FunctionTypeInfo>(string_view(from),
+            Span<FunctionParamView>(params.data(),params.data()+params.size())));
+
+        chain.push_back(i);
+        if(chain.size()>=max<size_t>(m_shape.chain_length,1))
+        {
+            //the loop is closed by the first function of the chain taking the last one
+            if(chain.size()>1 && chance(m_shape.cycle_ratio))
+            {
+                auto &first = scheme[m_names[chain.front()]];
+                auto closing = static_cast<const FunctionTypeInfo&>(*first).getParams();
+                vector<FunctionParamView> views;
+                for(const FunctionParam &param : closing)
+                    views.push_back({param.getKeyName(),param.isConst(),param.getRefPow()});
+                views.push_back({m_names[chain.back()],false,0});
+                first = make_shared<FunctionTypeInfo>(string_view(),
+                    Span<FunctionParamView>(views.data(),views.data()+views.size()));
+            }
+            chain.clear();
+        }
+    }
+    return scheme;
+}
+
+vector<LongName> SchemeGenerator::roots(size_t count)
+{
+    vector<LongName> roots;
+    for(size_t i = 0; i<count && !m_names.empty(); ++i)roots.push_back(m_names[pick(m_names.size())]);
+    sort(begin(roots),end(roots));
+    roots.erase(unique(begin(roots),end(roots)),end(roots));
+    return roots;
+}
@@ -0,0 +1,68 @@
+/*
+file:   SchemeGenerator.h
+
+author:	Aleksey Yakovlev
+data:	October 16, 2026
+
+Generator of synthetic schemes for the benchmarks of a task on the topic
+of code generation.
+
+The types are spread over a tree of namespaces of the given depth and fan-out.
+The functions take the given number of parameters referring to the other types
+and are linked into chains, where each function takes the previous one, so the
+declarations have to be ordered. A share of the chains is closed into a loop
+and a share of the types comes from the external modules.
+*/
+
+#ifndef SCHEME_GENERATOR_H
+#define SCHEME_GENERATOR_H
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "../CodegenAPI/CodegenAPI.h"
+
+namespace CodegenBench
+{
+    struct SchemeShape
+    {
+        std::size_t types = 1000;
+        std::size_t namespace_depth = 3;
+        std::size_t namespace_fanout = 4;
+        std::size_t min_params = 1;
+        std::size_t max_params = 4;
+        std::size_t chain_length = 8;
+        double function_ratio = 0.5;
+        double cycle_ratio = 0.0;
+        double external_ratio = 0.1;
+        std::uint32_t seed = 1;
+    };
+
+    class SchemeGenerator
+    {
+    protected:
+        SchemeShape m_shape;
+        std::mt19937 m_random;
+        std::vector<std::string> m_spaces;
+        std::vector<CodegenAPI::LongName> m_names;
+        std::vector<bool> m_functions;
+
+        bool chance(double ratio) { return std::uniform_real_distribution<double>(0.0,1.0)(m_random)<ratio; }
+        std::size_t pick(std::size_t count) { return std::uniform_int_distribution<std::size_t>(0,count-1)(m_random); }
+    public:
+        explicit SchemeGenerator(const SchemeShape &shape);
+
+        //the fundamental names the generated functions may refer to
+        static const std::set<CodegenAPI::LongName>& applied();
+
+        std::map<CodegenAPI::LongName,std::shared_ptr<CodegenAPI::TypeInfo>> scheme();
+        //a sample of the generated names to declare
+        std::vector<CodegenAPI::LongName> roots(std::size_t count);
+    };
+}
+#endif
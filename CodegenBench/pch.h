@@ -0,0 +1,7 @@
+#ifndef PCH_H
+#define PCH_H
+
+#include "../CodegenAPI/CodegenAPI.h"
+#include <iostream>
+
+#endif //PCH_H
@@ -0,0 +1,67 @@
+/*
+file:   CodegenClient.cpp
+
+author:	Aleksey Yakovlev
+data:	October 16, 2026
+
+Client of the resident generation server for a task on the topic of code generation.
+
+A build rule runs the client instead of a generator of its own, the server started
+by 'CodegenRun --serve' keeps the scheme built. The text is written to the file or
+to the standard output as it comes from the server.
+*/
+
+#include "pch.h"
+#include "../CodegenAPI/CodegenServer.h"
+
+using namespace CodegenAPI;
+using namespace std;
+
+static void usage()
+{
+    cout<<"usage: CodegenClient <socket> [options]\n"
+        <<"  --include NAME     a name to include, may repeat\n"
+        <<"  --declare NAME     a name to declare, may repeat\n"
+        <<"  --output FILE      the file of the text (the standard output)\n";
+}
+
+int main(int argc, char *argv[])
+{
+    int retcode;
+
+    try
+    {
+        if(argc<2 || string(argv[1])=="--help"){ usage(); return argc<2 ? -1 : 0; }
+        vector<LongName> include_names, declare_names;
+        string output;
+        for(int i = 2; i<argc; ++i)
+        {
+            string option = argv[i];
+            if(i+1>=argc)throw invalid_argument("missing value of "+option);
+            string value = argv[++i];
+            if(option=="--include")include_names.push_back(value);
+            else if(option=="--declare")declare_names.push_back(value);
+            else if(option=="--output")output = value;
+            else throw invalid_argument("unknown option "+option);
+        }
+
+        CodegenClient client(argv[1]);
+        if(output.empty())
+        {
+            StreamSink out(cout);
+            client.source(out,include_names,declare_names);
+        }
+        else
+        {
+            FileSink out(output);
+            client.source(out,include_names,declare_names);
+            out.close();
+        }
+
+        retcode = 0;
+    }
+    catch(const exception &ex) { cerr << ex.what() << endl; retcode=-1; }
+    catch(...) { cerr << "Unknown error"; retcode=-1; }
+
+    return retcode;
+}
@@ -5,21 +5,55 @@ author:	Aleksey Yakovlev
 data:	July 10, 2022
 
 Main program sample for a task on the topic of code generation.
+
+Started as 'CodegenRun --text' it generates a part of the sample from the same scheme
+written in the text of 'SchemeLoader'. Started as 'CodegenRun --serve <socket> <scheme>' it
+loads the scheme file once and serves the generation requests of 'CodegenClient'
+over the socket until killed.
 */
 
 #include "pch.h"
 #include "../CodegenAPI/CodegenAPI.h"
+#include "../CodegenAPI/CodegenServer.h"
 #include <iostream>
 
 using namespace CodegenAPI;
 using namespace std;
 
-int main()
+int main(int argc, char *argv[])
 {
     int retcode;
 
     try
     {
+        if(argc==4 && string(argv[1])=="--serve")
+        {
+            Codegen hg(SchemeLoader::load(argv[3]));
+            CodegenServer server(hg,argv[2]);
+            server.serve();
+            return 0;
+        }
+
+        if(argc==2 && string(argv[1])=="--text")
+        {
+            Codegen hg(SchemeLoader::parse(R"(
+                class std::string in <string>
+                class my_library::awesome
+                function my_library::func1 = void* (std::string, my_library::func1, const my_library::awesome, const my_library::inn::inn::struct1*)
+                function my_library::func2 = void* (std::string, my_library::func2, const my_library::awesome, const my_library::inn::inn::struct2*)
+                function astra::loss = const void* (my_library::awesome)
+                struct my_library::quick in my_library.h template T1, T2, T3
+                struct my_library::inn::inn::struct3 in my_library.h
+                struct my_library::inn::inn::struct1 in my_library.h
+                struct my_library::inn::inn::struct2 in my_library.h
+                class astra::bar
+            )"));
+
+            StreamSink out(cout);
+            hg.source(out,{"std::string"},{"my_library::quick","my_library::func1","astra::bar"});
+            return 0;
+        }
+
         Codegen hg {
             {"std::string",ClassTypeInfo::make("<string>")},
             {"my_library::awesome",ClassTypeInfo::make("")},
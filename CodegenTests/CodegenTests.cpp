@@ -11,6 +11,14 @@ Unit test and check module for a task on the topic of code generation.
 #include "CppUnitTest.h"
 
 #include "../CodegenAPI/CodegenAPI.h"
+#include "../CodegenAPI/StaticCodegen.h"
+#include "../CodegenAPI/CodegenServer.h"
+#include "../CodegenAPI/SharedCodegen.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <sstream>
+#include <thread>
 
 using namespace Microsoft::VisualStudio::CppUnitTestFramework;
 using namespace CodegenAPI;
@@ -18,6 +26,22 @@ using namespace std;
 
 namespace CodegenAPITests
 {
+    static constexpr StaticEntry static_scheme[] =
+    {
+        {"std::string",StaticClassInfo("<string>")},
+        {"lib::st",StaticStructInfo("",{"T1","T2"})},
+        {"lib::cl",StaticClassInfo("")},
+        {"lib::inn::func",StaticFunctionInfo("",{{"lib::cl",true,1},{"std::string"},{"lib::inn::st2"}})},
+        {"lib::inn::st2",StaticStructInfo("\"lib.h\"")},
+    };
+    static constexpr StaticEntry static_loop[] =
+    {
+        {"a::f",StaticFunctionInfo("",{{"void"},{"b::g"}})},
+        {"b::g",StaticFunctionInfo("",{{"void"},{"a::f"}})},
+    };
+    static_assert(StaticCodegen(static_loop).check({{},{"a::f"}})==StaticStatus::LoopForward,
+        "a dependency loop is found while compiling");
+
 	TEST_CLASS(HeaderGeneratorTests)
 	{
 	public:
@@ -93,6 +117,906 @@ namespace CodegenAPITests
             catch(const exception &ex) { testresult=false; emsg=ex.what(); }
             catch(...) { testresult=false; emsg="Unknown error"; }
 
+            Report(testresult,emsg);
+		}
+
+		TEST_METHOD(flatIndex)
+		{
+            bool testresult; string emsg;
+            try
+            {
+                //the lookups stay right while the index grows and in the copies of the table
+                NameTable table;
+                vector<NameId> ids;
+                for(int i=0; i<5000; ++i)ids.push_back(table.intern("ns"+to_string(i%50)+"::type"+to_string(i)));
+                NameTable copy = table;
+                testresult = table.size()==5000 && table.find("ns1::type")==NoName && copy.find("ns0::type5000")==NoName;
+                for(int i=0; i<5000; ++i)
+                {
+                    string name = "ns"+to_string(i%50)+"::type"+to_string(i);
+                    testresult = testresult && table.find(name)==ids[i] && copy.find(name)==ids[i] && table.view(ids[i])==name;
+                }
+
+                //a type is found by one probe, the ordered scheme keeps the order of the names
+                Codegen hg 
+                {
+                   {"lib::b",StructTypeInfo::make("")},
+                   {"lib::a",ClassTypeInfo::make("a.h")},
+                   {"lib::func",FunctionTypeInfo::make("",{{"void"},{"lib::a"},{"lib::b"}})},
+                };
+                const map<LongName,shared_ptr<TypeInfo>> &scheme = hg.getSheme();
+                testresult = testresult && hg.findType("lib::a")==scheme.at("lib::a").get() && !hg.findType("lib::c") &&
+                    !hg.findType("lib") && begin(scheme)->first=="lib::a" && prev(end(scheme))->first=="lib::func";
+            }
+            catch(const exception &ex) { testresult=false; emsg=ex.what(); }
+            catch(...) { testresult=false; emsg="Unknown error"; }
+
+            Report(testresult,emsg);
+		}
+
+		TEST_METHOD(nameInterning)
+		{
+            bool testresult; string emsg;
+            try
+            {
+                //an identical name gets the same identifier, the table holds the distinct names only
+                NameTable table;
+                vector<string> names{"lib::a","lib::b","lib::a","void","lib::b","lib::a"};
+                vector<NameId> ids;
+                for(const string &name : names)ids.push_back(table.intern(name));
+                testresult = table.size()==3 && ids[0]==ids[2] && ids[0]==ids[5] && ids[1]==ids[4] &&
+                    ids[0]!=ids[1] && ids[3]!=ids[0] && table.view(ids[0])=="lib::a";
+
+                //a copy keeps the names of the original while both of them go on interning
+                NameTable copy = table;
+                NameId copied = copy.intern("lib::c"), original = table.intern("lib::d");
+                testresult = testresult && copied==original && copy.view(copied)=="lib::c" &&
+                    table.view(original)=="lib::d" && copy.view(ids[0])=="lib::a" && copy.find("lib::d")==NoName;
+
+                //the names kept by the arena are referred to in place by the name table of the generator,
+                //which holds the keys, their namespace and the applied names once
+                auto arena = make_shared<SchemeArena>();
+                arena->add("lib::st",StructTypeInfo::make(*arena,""));
+                arena->add("lib::func",FunctionTypeInfo::make(*arena,"",{{"void"},{"lib::st",true,1},{"lib::func"}}));
+                const char *kept = arena->intern("lib::st").data();
+                Codegen hg(arena); arena.reset();
+                const NameTable &scheme_names = hg.getNames();
+                testresult = testresult && scheme_names.view(scheme_names.find("lib::st")).data()==kept &&
+                    scheme_names.size()==12 && scheme_names.find("lib")!=NoName;
+
+                Codegen heap 
+                {
+                   {"lib::st",StructTypeInfo::make("")},
+                   {"lib::func",FunctionTypeInfo::make("",{{"void"},{"lib::st",true,1},{"lib::func"}})},
+                };
+                testresult = testresult && heap.getNames().size()==12 &&
+                    hg.source({},{"lib::func"})==heap.source({},{"lib::func"});
+            }
+            catch(const exception &ex) { testresult=false; emsg=ex.what(); }
+            catch(...) { testresult=false; emsg="Unknown error"; }
+
+            Report(testresult,emsg);
+		}
+
+		TEST_METHOD(outputSinks)
+		{
+            bool testresult; string emsg;
+            try
+            {
+                //a negative power of the pointer writes no stars, as the text of the parameter
+                FunctionParam negative("lib::inn::cl",true,-2);
+                BufferSink param_sink; negative.view(param_sink,"lib::");
+                testresult = param_sink.view()=="const inn::cl" && negative.view("lib::")=="const inn::cl";
+
+                Codegen hg 
+                {
+                   {"lib::func",FunctionTypeInfo::make("",{{"void",false,-1},{"lib::inn::cl",true,-2},{"lib::st",false,2}})},
+                   {"lib::inn::cl",ClassTypeInfo::make("cl.h")},
+                   {"lib::st",StructTypeInfo::make("")},
+                };
+                string text = hg.source({}, {"lib::func"});
+                ostringstream stream;
+                { StreamSink sink(stream,16); hg.source(sink,{},{"lib::func"}); }
+                { FileSink sink("output_sinks.h",16); hg.source(sink,{},{"lib::func"}); sink.close(); }
+                testresult = testresult && stream.str()==text && MappedFile("output_sinks.h").view()==text &&
+                    hg.code({}, {"lib::func"}).translate(hg.getSheme())==text;
+                filesystem::remove("output_sinks.h");
+            }
+            catch(const exception &ex) { testresult=false; emsg=ex.what(); }
+            catch(...) { testresult=false; emsg="Unknown error"; }
+
+            Report(testresult,emsg);
+		}
+
+		TEST_METHOD(arenaScheme)
+		{
+            bool testresult; string emsg;
+            try
+            {
+                auto arena = make_shared<SchemeArena>();
+                arena->add("std::string",ClassTypeInfo::make(*arena,"<string>"));
+                arena->add("lib::func1",FunctionTypeInfo::make(*arena,"funcs.h",
+                    {{"void",false,1},{"std::string"},{"lib::func1"},{"lib::inn::st1",true,1}}));
+                arena->add("lib::inn::st1",StructTypeInfo::make(*arena,"lib.h"));
+                arena->add("lib::inn::st3",StructTypeInfo::make(*arena,"",{"T1","T2"}));
+                arena->add("lib::bad",FunctionTypeInfo::make(*arena,"",{{"void"},{"lib::inn::st3"}}));
+
+                //the names of the keys and of the parameters are kept once by the arena
+                const auto &params = static_cast<const FunctionTypeInfo*>(arena->entries()[1].second)->getParams();
+                testresult = &params[2].getKeyName()==&arena->intern("lib::func1") &&
+                    params[2].getKeyNameView().data()==arena->entries()[1].first.data() &&
+                    arena->entries()[4].first.data()==arena->intern("lib::bad").data();
+
+                Codegen hg(arena); arena.reset();
+                testresult = testresult && hg.test({"std::string"}, { "lib::func1", "lib::inn::st1", "lib::inn::st3"}) &&
+                    !hg.tryCode({},{"lib::bad"}).ok() && hg.getSheme().size()==5;
+            }
+            catch(const exception &ex) { testresult=false; emsg=ex.what(); }
+            catch(...) { testresult=false; emsg="Unknown error"; }
+
+            Report(testresult,emsg);
+		}
+
+		TEST_METHOD(dependencyGraph)
+		{
+            bool testresult; string emsg;
+            try
+            {
+                //the dependencies of a type are one range of the edges, the applied names stay in it
+                map<LongName,shared_ptr<TypeInfo>> types
+                {
+                   {"lib::st",StructTypeInfo::make("")},
+                   {"lib::func",FunctionTypeInfo::make("",{{"void"},{"lib::st",true,1},{"lib::none"}})},
+                };
+                InternedScheme scheme(types,{"void"});
+                Span<NameId> depends = scheme.dependencies(scheme.find("lib::func"));
+                testresult = depends.size()==3 && scheme.view(depends[0])=="void" && scheme.isApplied(depends[0]) &&
+                    scheme.view(depends[1])=="lib::st" && scheme.info(depends[1])==types["lib::st"].get() &&
+                    scheme.view(depends[2])=="lib::none" && !scheme.info(depends[2]) &&
+                    scheme.dependencies(scheme.find("lib::st")).empty();
+
+                //the types are checked at the load, a rejected type fails only the requests reaching it
+                Codegen hg 
+                {
+                   {"lib::tmpl",StructTypeInfo::make("",{"T"})},
+                   {"lib::bad",FunctionTypeInfo::make("",{{"void"},{"lib::tmpl"}})},
+                   {"lib::user",FunctionTypeInfo::make("",{{"void"},{"lib::bad"}})},
+                };
+                testresult = testresult && hg.tryCode({},{"lib::tmpl"}).ok() && !hg.tryCode({},{"lib::bad"}).ok() &&
+                    !hg.tryCode({},{"lib::user"}).ok();
+                hg.replaceType("lib::tmpl",StructTypeInfo::make(""));
+                testresult = testresult && hg.tryCode({},{"lib::user"}).ok();
+            }
+            catch(const exception &ex) { testresult=false; emsg=ex.what(); }
+            catch(...) { testresult=false; emsg="Unknown error"; }
+
+            Report(testresult,emsg);
+		}
+
+		TEST_METHOD(loopMembers)
+		{
+            bool testresult; string emsg;
+            try
+            {
+                Codegen hg 
+                {
+                   {"lib::func_a",FunctionTypeInfo::make("",{{"lib::func_b"}})},
+                   {"lib::func_b",FunctionTypeInfo::make("",{{"lib::inn::func_c"}})},
+                   {"lib::inn::func_c",FunctionTypeInfo::make("",{{"lib::func_b"}})},
+                   {"lib::func_d",FunctionTypeInfo::make("",{{"lib::func_a"}})},
+                };
+                testresult = hg.test({}, {"lib::func_d"}), false;
+            }
+            catch(const LoopForwardError &ex)
+            {
+                vector<string> members = ex.members(); sort(begin(members),end(members));
+                testresult = members==vector<string>{"lib::func_b","lib::inn::func_c"}; emsg=ex.what();
+            }
+            catch(const exception &ex) { testresult=false; emsg=ex.what(); }
+            catch(...) { testresult=false; emsg="Unknown error"; }
+
+            Report(testresult,emsg);
+		}
+
+		TEST_METHOD(emptyNamespace)
+		{
+            bool testresult; string emsg;
+            try
+            {
+                //an empty segment of a key is a namespace without a name, as the original generator took it
+                Codegen hg 
+                {
+                   {"::a",StructTypeInfo::make("")},
+                   {"lib::f",FunctionTypeInfo::make("",{{"void"},{"::a"}})},
+                };
+                string text = hg.source({}, {"::a","lib::f"});
+                testresult = text=="namespace \n{\n\tstruct a;\n}\nnamespace lib\n{\n\tusing f = void (*)(::a);\n}\n" &&
+                    hg.code({}, {"::a","lib::f"}).translate(hg.getSheme())==text && hg.test({}, {"::a","lib::f"});
+
+                //a single colon and an empty last segment stay errors
+                Codegen bad {{"lib:a",StructTypeInfo::make("")},{"lib::",StructTypeInfo::make("")}};
+                try { bad.code({}, {"lib:a"}); testresult = false; } catch(const SyntaxError&) { }
+                try { bad.code({}, {"lib::"}); testresult = false; } catch(const SyntaxError&) { }
+            }
+            catch(const exception &ex) { testresult=false; emsg=ex.what(); }
+            catch(...) { testresult=false; emsg="Unknown error"; }
+
+            Report(testresult,emsg);
+		}
+
+		TEST_METHOD(batchGeneration)
+		{
+            bool testresult; string emsg;
+            try
+            {
+                Codegen hg 
+                {
+                   {"std::string",ClassTypeInfo::make("<string>")},
+                   {"lib::st",StructTypeInfo::make("")},
+                   {"lib::tmpl",StructTypeInfo::make("",{"T"})},
+                   {"lib::func_a",FunctionTypeInfo::make("",{{"void"},{"lib::st",true,1}})},
+                   {"lib::func_b",FunctionTypeInfo::make("",{{"std::string"},{"lib::func_a"}})},
+                   {"lib::func_t",FunctionTypeInfo::make("",{{"void"},{"lib::tmpl"}})},
+                };
+                vector<CodeRequest> requests
+                {
+                    {{"std::string"},{"lib::func_a"}},
+                    {{},{"lib::func_b","lib::func_a"}},
+                    {{},{"lib::st"}},
+                };
+                //the results agree with the single requests, on an own pool and on the kept one
+                ThreadPool pool(2);
+                vector<string> texts = hg.sourceBatch(requests,pool);
+                vector<IntermediateCode> codes = hg.codeBatch(requests);
+                testresult = texts.size()==requests.size() && codes.size()==requests.size() &&
+                    hg.sourceBatch(requests,2)==texts && hg.sourceBatch(requests,2)==texts;
+                for(size_t i=0; i<requests.size(); ++i)
+                    testresult = testresult && texts[i]==hg.source(requests[i].include_names,requests[i].declare_names) &&
+                        codes[i].translate(hg.getSheme())==texts[i];
+
+                //the first failed request rethrows the first problem met walking its names breadth first,
+                //so the rejected type declared first wins over a missing name declared after it
+                auto error = [&hg](const vector<CodeRequest> &requests)
+                {
+                    try { hg.sourceBatch(requests,2); } catch(const exception &ex) { return string(ex.what()); }
+                    return string();
+                };
+                auto single = [&hg](const vector<LongName> &declare_names)
+                {
+                    try { hg.source({},declare_names); } catch(const exception &ex) { return string(ex.what()); }
+                    return string();
+                };
+                string rejected = single({"lib::func_t"}), missing = single({"lib::none"});
+                testresult = testresult && !rejected.empty() && !missing.empty() && rejected!=missing &&
+                    single({"lib::func_t","lib::none"})==rejected && single({"lib::none","lib::func_t"})==missing &&
+                    error({{{},{"lib::st"}},{{},{"lib::func_t","lib::none"}},{{},{"lib::none"}}})==rejected &&
+                    error({{{},{"lib::st"}},{{},{"lib::none","lib::func_t"}}})==missing;
+            }
+            catch(const exception &ex) { testresult=false; emsg=ex.what(); }
+            catch(...) { testresult=false; emsg="Unknown error"; }
+
+            Report(testresult,emsg);
+		}
+
+		TEST_METHOD(mutableScheme)
+		{
+            bool testresult; string emsg;
+            try
+            {
+                Codegen hg 
+                {
+                   {"lib::func_a",FunctionTypeInfo::make("",{{"lib::st"}})},
+                   {"lib::st",StructTypeInfo::make("")},
+                };
+                string before = hg.source({}, {"lib::func_a"});
+                hg.replaceType("lib::st",StructTypeInfo::make("st.h"));
+                hg.addType("lib::func_b",FunctionTypeInfo::make("",{{"lib::func_a"}}));
+                string after = hg.source({}, {"lib::func_a"});
+                testresult = before!=after && after==Codegen(hg.getSheme()).source({}, {"lib::func_a"}) &&
+                    hg.test({}, {"lib::func_b"});
+                hg.removeType("lib::func_b");
+                testresult = testresult && !hg.findType("lib::func_b");
+            }
+            catch(const exception &ex) { testresult=false; emsg=ex.what(); }
+            catch(...) { testresult=false; emsg="Unknown error"; }
+
+            Report(testresult,emsg);
+		}
+
+		TEST_METHOD(copiedScheme)
+		{
+            bool testresult; string emsg;
+            try
+            {
+                Codegen hg 
+                {
+                   {"lib::func_a",FunctionTypeInfo::make("",{{"lib::st"}})},
+                   {"lib::st",StructTypeInfo::make("")},
+                };
+                string before = hg.source({}, {"lib::func_a"});
+                size_t names = hg.getNames().size();
+                Codegen copy = hg;
+                copy.replaceType("lib::st",StructTypeInfo::make("st.h"));
+                copy.addType("ext::inn::func_b",FunctionTypeInfo::make("",{{"ext::cl"},{"lib::func_a"}}));
+                copy.addType("ext::cl",ClassTypeInfo::make(""));
+                testresult = hg.source({}, {"lib::func_a"})==before && hg.getNames().size()==names &&
+                    hg.getNames().find("ext::inn::func_b")==NoName && copy.getNames().size()>names &&
+                    copy.source({}, {"lib::func_a"})!=before && copy.test({}, {"ext::inn::func_b"});
+            }
+            catch(const exception &ex) { testresult=false; emsg=ex.what(); }
+            catch(...) { testresult=false; emsg="Unknown error"; }
+
+            Report(testresult,emsg);
+		}
+
+		TEST_METHOD(snapshotScheme)
+		{
+            bool testresult; string emsg;
+            try
+            {
+                Codegen hg 
+                {
+                    {"std::string",ClassTypeInfo::make("<string>")},
+                    {"lib::func1",FunctionTypeInfo::make("funcs.h",{{"void",false,1},{"std::string"},{"lib::inn::st1",true,1}})},
+                    {"lib::inn::st1",StructTypeInfo::make("lib.h")},
+                    {"lib::inn::st3",StructTypeInfo::make("",{"T1","T2"})},
+                };
+                { FileSink sink("snapshot_scheme.bin"); hg.save(sink); sink.close(); }
+                Codegen mapped(Snapshot::open("snapshot_scheme.bin"));
+                testresult = mapped.source({"std::string"},{"lib::func1","lib::inn::st3"})==
+                    hg.source({"std::string"},{"lib::func1","lib::inn::st3"}) &&
+                    mapped.test({"std::string"},{"lib::func1","lib::inn::st3"}) &&
+                    mapped.getSheme().size()==hg.getSheme().size();
+            }
+            catch(const exception &ex) { testresult=false; emsg=ex.what(); }
+            catch(...) { testresult=false; emsg="Unknown error"; }
+
+            Report(testresult,emsg);
+		}
+
+		TEST_METHOD(textScheme)
+		{
+            bool testresult; string emsg;
+            try
+            {
+                Codegen hg(SchemeLoader::parse(
+                    "# sample scheme\n"
+                    "class std::string in <string>\n"
+                    "function lib::func1 in funcs.h = void* (std::string, const lib::inn::st1*)\n"
+                    "struct lib::inn::st1 in lib.h\n"
+                    "struct lib::inn::st3 template T1, T2\n"));
+                testresult = hg.test({"std::string"},{"lib::func1","lib::inn::st1","lib::inn::st3"});
+                try { SchemeLoader::parse("class a\nfunction f = void\n"); testresult = false; }
+                catch(const SyntaxError &ex) { testresult = testresult && ex.line()==2; }
+            }
+            catch(const exception &ex) { testresult=false; emsg=ex.what(); }
+            catch(...) { testresult=false; emsg="Unknown error"; }
+
+            Report(testresult,emsg);
+		}
+
+		TEST_METHOD(codegenStats)
+		{
+            bool testresult; string emsg;
+            try
+            {
+                Codegen hg 
+                {
+                    {"std::string",ClassTypeInfo::make("<string>")},
+                    {"lib::inn::func1",FunctionTypeInfo::make("",{{"lib::st1"},{"std::string"}})},
+                    {"lib::st1",StructTypeInfo::make("")},
+                };
+                CodegenStats stats;
+                string traced = hg.source({},{"lib::inn::func1"},&stats);
+                testresult = traced==hg.source({},{"lib::inn::func1"}) && hg.test({},{"lib::inn::func1"},&stats);
+                const CodegenStats::Counters &counters = stats.counters();
+                testresult = testresult && counters.closure_forwards==4 && counters.memo_hits==1 &&
+                    counters.namespaces_opened==counters.namespaces_closed && stats.iterations().count("lib::inn") &&
+                    stats.calls(CodegenStats::Phase::Rendering)==2 && stats.calls(CodegenStats::Phase::Verification)==1 &&
+                    stats.json().find("\"peak_code_size\":")!=string::npos;
+            }
+            catch(const exception &ex) { testresult=false; emsg=ex.what(); }
+            catch(...) { testresult=false; emsg="Unknown error"; }
+
+            Report(testresult,emsg);
+		}
+
+		TEST_METHOD(codeEquality)
+		{
+            bool testresult; string emsg;
+            try
+            {
+                Codegen hg 
+                {
+                   {"lib::func_a",FunctionTypeInfo::make("",{{"lib::st"}})},
+                   {"lib::st",StructTypeInfo::make("")},
+                };
+                IntermediateCode icode;
+                icode.openNamespace("lib"); icode.declareForward("st"); icode.declareForward("func_a");
+                icode.closeNamespace();
+                testresult = hg.code({}, {"lib::func_a"})==hg.code({}, {"lib::func_a"}) &&
+                    icode==hg.code({}, {"lib::func_a"}) && icode.size()==4 &&
+                    icode.translate(hg.getSheme())==hg.source({}, {"lib::func_a"});
+            }
+            catch(const exception &ex) { testresult=false; emsg=ex.what(); }
+            catch(...) { testresult=false; emsg="Unknown error"; }
+
+            Report(testresult,emsg);
+		}
+
+		TEST_METHOD(streamingVerification)
+		{
+            bool testresult; string emsg;
+            try
+            {
+                Codegen hg 
+                {
+                    {"std::string",ClassTypeInfo::make("<string>")},
+                    {"lib::func1",FunctionTypeInfo::make("funcs.h",{{"void",false,1},{"std::string"},{"lib::inn::st1",true,1}})},
+                    {"lib::inn::st1",StructTypeInfo::make("lib.h")},
+                };
+                string plain = hg.source({"std::string"},{"lib::func1"});
+                hg.setVerification(true);
+                testresult = hg.test({"std::string"},{"lib::func1"}) &&
+                    hg.source({"std::string"},{"lib::func1"})==plain;
+
+                IntermediateCode icode;
+                icode.openNamespace("lib"); icode.declareForward("func1"); icode.closeNamespace();
+                try { icode.verify(hg.getSheme(),{},{"lib::func1"},{}); testresult = false; }
+                catch(const NotFoundModuleError&) { }
+            }
+            catch(const exception &ex) { testresult=false; emsg=ex.what(); }
+            catch(...) { testresult=false; emsg="Unknown error"; }
+
+            Report(testresult,emsg);
+		}
+
+		TEST_METHOD(namespaceIndex)
+		{
+            bool testresult; string emsg;
+            try
+            {
+                Codegen hg 
+                {
+                   {"lib::inn::func_a",FunctionTypeInfo::make("",{{"lib::st"}})},
+                   {"lib::st",StructTypeInfo::make("")},
+                   {"lib::st2",StructTypeInfo::make("")},
+                };
+                string first = hg.source({}, {"lib::inn::func_a","lib::st2"});
+                testresult = first==hg.source({}, {"lib::inn::func_a","lib::st2"});
+                hg.addType("lib::other::st3",StructTypeInfo::make(""));
+                hg.removeType("lib::st2");
+                testresult = testresult && hg.source({}, {"lib::inn::func_a","lib::other::st3"})==
+                    Codegen(hg.getSheme()).source({}, {"lib::inn::func_a","lib::other::st3"});
+                try { Codegen({{"lib:st",StructTypeInfo::make("")}}).source({}, {"lib:st"}); testresult = false; }
+                catch(const SyntaxError&) { }
+            }
+            catch(const exception &ex) { testresult=false; emsg=ex.what(); }
+            catch(...) { testresult=false; emsg="Unknown error"; }
+
+            Report(testresult,emsg);
+		}
+
+		TEST_METHOD(shardedSource)
+		{
+            bool testresult; string emsg;
+            try
+            {
+                Codegen hg 
+                {
+                   {"app::func",FunctionTypeInfo::make("",{{"lib::st"},{"ext::ex"}})},
+                   {"lib::st",StructTypeInfo::make("")},
+                   {"ext::ex",StructTypeInfo::make("<ext.h>")},
+                   {"loop::a",FunctionTypeInfo::make("",{{"cyc::b"}})},
+                   {"cyc::b",FunctionTypeInfo::make("",{{"loop::c"}})},
+                   {"loop::c",StructTypeInfo::make("")},
+                };
+                hg.setVerification(true);
+                ShardOptions options;
+                vector<Shard> one = hg.sourceShards({}, {"app::func","loop::a"}, options);
+                testresult = one.size()==1 && one[0].text=="#pragma once\n"+hg.source({}, {"app::func","loop::a"});
+
+                options.budget = 1;
+                vector<Shard> shards = hg.sourceShards({}, {"app::func","loop::a"}, options);
+                size_t declared = 0;
+                for(const Shard &shard : shards)declared += shard.forwards.size();
+                //the loop of namespaces stays in one shard, the user includes the shard of its dependency
+                testresult = testresult && shards.size()==3 && declared==5 &&
+                    shards[0].forwards.size()==3 && shards[1].forwards==vector<LongName>{"lib::st"} &&
+                    shards[2].includes==vector<string>{"shard_1.h"} &&
+                    shards[2].text.find("#include \"shard_1.h\"")!=string::npos;
+            }
+            catch(const exception &ex) { testresult=false; emsg=ex.what(); }
+            catch(...) { testresult=false; emsg="Unknown error"; }
+
+            Report(testresult,emsg);
+		}
+
+		TEST_METHOD(moduleGraph)
+		{
+            bool testresult; string emsg;
+            try
+            {
+                map<LongName,shared_ptr<TypeInfo>> scheme
+                {
+                   {"std::string",ClassTypeInfo::make("<string>")},
+                   {"std::vector",ClassTypeInfo::make("<vector>",{"T"})},
+                   {"my_library::st",StructTypeInfo::make("\"my_library.h\"")},
+                   {"app::func",FunctionTypeInfo::make("",{{"void"},{"std::string"},{"my_library::st"}})},
+                };
+                ModuleGraph modules;
+                modules.addInclude("\"my_library.h\"","<string>");
+                Codegen hg(scheme);
+                hg.setModuleGraph(modules);
+                string text = hg.source({"std::vector"}, {"app::func"});
+                testresult = text.find("<string>")==string::npos && text.find("<vector>")!=string::npos &&
+                    text.find("\"my_library.h\"")!=string::npos && hg.test({"std::string"}, {"app::func"});
+
+                //the reduced code is accepted only with the graph
+                IntermediateCode code = hg.code({}, {"app::func"});
+                testresult = testresult && code.verify(scheme,{"std::string"},{"app::func"},{"void"},modules);
+                try { code.verify(scheme,{},{"app::func"},{"void"}); testresult = false; }
+                catch(const NotFoundModuleError&) { }
+            }
+            catch(const exception &ex) { testresult=false; emsg=ex.what(); }
+            catch(...) { testresult=false; emsg="Unknown error"; }
+
+            Report(testresult,emsg);
+		}
+
+		TEST_METHOD(staticCodegen)
+		{
+            bool testresult; string emsg;
+            try
+            {
+                constexpr StaticCodegen hg(static_scheme);
+                constexpr StaticRequest request{{"std::string"},{"lib::st","lib::inn::func"}};
+                static_assert(hg.check(request)==StaticStatus::Ok,"the scheme is checked while compiling");
+                constexpr auto header = hg.source<hg.sourceSize(request)>(request);
+                static_assert(header.size()==hg.sourceSize(request) && header.c_str()[header.size()]==0);
+
+                Codegen runtime
+                {
+                   {"std::string",ClassTypeInfo::make("<string>")},
+                   {"lib::st",StructTypeInfo::make("",{"T1","T2"})},
+                   {"lib::cl",ClassTypeInfo::make("")},
+                   {"lib::inn::func",FunctionTypeInfo::make("",{{"lib::cl",true,1},{"std::string"},{"lib::inn::st2"}})},
+                   {"lib::inn::st2",StructTypeInfo::make("\"lib.h\"")},
+                };
+                testresult = header.view()==runtime.source({"std::string"}, {"lib::st","lib::inn::func"});
+                try { hg.source<1>(request); testresult = false; }
+                catch(const length_error&) { }
+            }
+            catch(const exception &ex) { testresult=false; emsg=ex.what(); }
+            catch(...) { testresult=false; emsg="Unknown error"; }
+
+            Report(testresult,emsg);
+		}
+
+		TEST_METHOD(translatedSize)
+		{
+            bool testresult; string emsg;
+            try
+            {
+                //the size and the text written in place agree with the text of the sink
+                auto exact = [](const TypeInfo &info, const string &key, const string &name)
+                {
+                    BufferSink sink; info.translate(sink,key,name);
+                    string text(info.translatedSize(key,name),'\0');
+                    return info.translate(text.data(),key,name)==text.data()+text.size() && text==sink.view();
+                };
+                auto st = StructTypeInfo::make("",{"T1","T2"});
+                auto cl = ClassTypeInfo::make("<cl>");
+                auto func = FunctionTypeInfo::make("",{{"void",false,2},{"lib::inn::st",true,1},{"lib::other"},{"std::string"}});
+                testresult = exact(*st,"lib::","st") && exact(*cl,"","cl") &&
+                    exact(*func,"lib::","func") && exact(*func,"","lib::func");
+
+                //a negative power of the pointer writes no stars and takes no room
+                auto negative = FunctionTypeInfo::make("",{{"void",false,-1},{"lib::cl",true,-2}});
+                string in_place(negative->translatedSize("lib::","func"),'\0');
+                testresult = testresult &&
+                    negative->translate(in_place.data(),"lib::","func")==in_place.data()+in_place.size() &&
+                    in_place=="using func = void (*)(const cl);\n";
+
+                Codegen hg 
+                {
+                   {"std::string",ClassTypeInfo::make("<string>")},
+                   {"lib::func",func},
+                   {"lib::inn::st",StructTypeInfo::make("")},
+                   {"lib::other",ClassTypeInfo::make("other.h")},
+                };
+                BufferSink sink; hg.source(sink,{"std::string"},{"lib::func"});
+                testresult = testresult && hg.source({"std::string"},{"lib::func"})==sink.view() &&
+                    hg.code({"std::string"},{"lib::func"}).translate(hg.getSheme())==sink.view();
+            }
+            catch(const exception &ex) { testresult=false; emsg=ex.what(); }
+            catch(...) { testresult=false; emsg="Unknown error"; }
+
+            Report(testresult,emsg);
+		}
+
+		TEST_METHOD(generationServer)
+		{
+            bool testresult; string emsg;
+            try
+            {
+                Codegen hg 
+                {
+                   {"std::string",ClassTypeInfo::make("<string>")},
+                   {"lib::func",FunctionTypeInfo::make("",{{"void"},{"std::string"},{"lib::inn::st",true,1}})},
+                   {"lib::inn::st",StructTypeInfo::make("")},
+                   {"lib::loop",FunctionTypeInfo::make("",{{"void"},{"lib::loop2"}})},
+                   {"lib::loop2",FunctionTypeInfo::make("",{{"void"},{"lib::loop"}})},
+                };
+                CodegenServer server(hg,"codegen_tests.sock",1);
+                thread serving([&server]() { server.serve(); });
+
+                //three clients at once on one worker, the idle connections do not hold it,
+                //the second one sends two requests over its connection
+                CodegenClient first("codegen_tests.sock"), second("codegen_tests.sock"), third("codegen_tests.sock");
+                testresult = first.source({"std::string"},{"lib::func"})==hg.source({"std::string"},{"lib::func"}) &&
+                    second.source({},{"lib::inn::st"})==hg.source({},{"lib::inn::st"}) &&
+                    third.source({},{"lib::inn::st"})==hg.source({},{"lib::inn::st"});
+                try { second.source({},{"lib::loop"}); testresult = false; }
+                catch(const RemoteError&) { }
+                testresult = testresult && second.source({"std::string"},{"lib::func"})==hg.source({"std::string"},{"lib::func"}) &&
+                    first.source({},{"lib::inn::st"})==hg.source({},{"lib::inn::st"});
+
+                server.stop();
+                serving.join();
+            }
+            catch(const exception &ex) { testresult=false; emsg=ex.what(); }
+            catch(...) { testresult=false; emsg="Unknown error"; }
+
+            Report(testresult,emsg);
+		}
+
+		TEST_METHOD(outputCache)
+		{
+            bool testresult; string emsg;
+            try
+            {
+                Codegen hg 
+                {
+                   {"std::string",ClassTypeInfo::make("<string>")},
+                   {"lib::func",FunctionTypeInfo::make("",{{"void"},{"std::string"},{"lib::inn::st",true,1}})},
+                   {"lib::inn::st",StructTypeInfo::make("")},
+                   {"lib::other",ClassTypeInfo::make("")},
+                };
+                filesystem::remove_all("codegen_tests_cache");
+                OutputCache cache("codegen_tests_cache");
+                string key = hg.fingerprint({},{"lib::func"}), text;
+                testresult = !cache.find(key,text) && hg.source(cache,{},{"lib::func"})==hg.source({},{"lib::func"}) &&
+                    cache.find(key,text) && text==hg.source({},{"lib::func"});
+
+                //the edits outside the closure keep the entry, an edit of a dependency changes it
+                hg.replaceType("lib::other",StructTypeInfo::make(""));
+                hg.addType("lib::inn::more",ClassTypeInfo::make(""));
+                testresult = testresult && hg.fingerprint({},{"lib::func"})==key;
+                hg.replaceType("lib::inn::st",ClassTypeInfo::make(""));
+                testresult = testresult && hg.fingerprint({},{"lib::func"})!=key;
+
+                //the output is written once and left untouched while its text stays
+                testresult = testresult && hg.writeSource("codegen_tests_cache/func.h",cache,{},{"lib::func"}) &&
+                    !hg.writeSource("codegen_tests_cache/func.h",cache,{},{"lib::func"});
+                filesystem::remove_all("codegen_tests_cache");
+            }
+            catch(const exception &ex) { testresult=false; emsg=ex.what(); }
+            catch(...) { testresult=false; emsg="Unknown error"; }
+
+            Report(testresult,emsg);
+		}
+
+		TEST_METHOD(lazyScheme)
+		{
+            bool testresult; string emsg;
+            try
+            {
+                const string scheme =
+                    "class std::string in <string>\n"
+                    "# the types are fetched by their names\n"
+                    "function lib::func = void (std::string, const lib::inn::st*)\n"
+                    "struct lib::inn::st\n"
+                    "class lib::other\n";
+                filesystem::remove_all("codegen_tests_index");
+                filesystem::create_directories("codegen_tests_index");
+                { FileSink sink("codegen_tests_index/scheme.txt"); sink<<scheme; sink.close(); }
+                IndexResolver::build("codegen_tests_index/scheme.txt","codegen_tests_index/shards",4);
+
+                //the cache keeps two types at most, the generation is the same as over the whole scheme
+                auto cached = make_shared<CachedResolver>(make_shared<IndexResolver>("codegen_tests_index/shards"),2);
+                Codegen lazy(cached), whole(SchemeLoader::parse(scheme));
+                testresult = lazy.source({"lib::other"},{"lib::func"})==whole.source({"lib::other"},{"lib::func"}) &&
+                    lazy.code({},{"lib::func"}).translate(*cached)==whole.source({},{"lib::func"}) &&
+                    cached->size()==2 && !cached->resolve("lib::none");
+                try { lazy.source({},{"lib::none"}); testresult = false; }
+                catch(const NotFoundKeyError&) { }
+
+                { FileSink sink("codegen_tests_index/scheme.txt"); sink<<scheme<<"struct lib::other\n"; sink.close(); }
+                try { IndexResolver::build("codegen_tests_index/scheme.txt","codegen_tests_index/shards",4); testresult = false; }
+                catch(const DuplicateKeyError&) { }
+                filesystem::remove_all("codegen_tests_index");
+            }
+            catch(const exception &ex) { testresult=false; emsg=ex.what(); }
+            catch(...) { testresult=false; emsg="Unknown error"; }
+
+            Report(testresult,emsg);
+		}
+
+		TEST_METHOD(diagnostics)
+		{
+            bool testresult; string emsg;
+            try
+            {
+                map<LongName,shared_ptr<TypeInfo>> scheme
+                {
+                   {"std::string",ClassTypeInfo::make("<string>")},
+                   {"lib::tpl",ClassTypeInfo::make("",{"T"})},
+                   {"lib::bad",FunctionTypeInfo::make("",{{"void"},{"lib::tpl"}})},
+                   {"lib::func",FunctionTypeInfo::make("",{{"void"},{"std::string"},{"lib::gone"}})},
+                };
+                Codegen hg(scheme);
+                auto kinds = [](const Diagnostics &diagnostics)
+                {
+                    vector<DiagnosticKind> kinds;
+                    for(const Diagnostic &diagnostic : diagnostics)kinds.push_back(diagnostic.kind);
+                    return kinds;
+                };
+
+                //one run lists every problem, the throwing method raises the first of them
+                CodeResult result = hg.tryCode({"lib::none"},{"lib::missing","lib::func","lib::bad"});
+                testresult = !result.ok() && kinds(result.diagnostics)==vector<DiagnosticKind>{DiagnosticKind::NotFoundKey,
+                    DiagnosticKind::NotFoundKey,DiagnosticKind::RejectedType,DiagnosticKind::NotFoundKey} &&
+                    result.diagnostics.entries()[1].name=="lib::gone" && result.diagnostics.entries()[2].name=="lib::bad";
+                try { hg.code({"lib::none"},{"lib::missing","lib::func","lib::bad"}); testresult = false; }
+                catch(const NotFoundKeyError &ex) { testresult = testresult && result.diagnostics.entries()[0].message==ex.what(); }
+                testresult = testresult && hg.tryCode({"std::string"},{"lib::tpl"}).ok() &&
+                    hg.diagnose({},{"lib::func"}).size()==1 && hg.diagnoseScheme().size()==1;
+
+                //a key with no place in the namespaces is listed as well, the other forwards are rendered
+                Codegen malformed {{"lib:bad",StructTypeInfo::make("")},{"lib::st",StructTypeInfo::make("")}};
+                CodeResult partial = malformed.tryCode({},{"lib:bad","lib::st"});
+                testresult = testresult && kinds(partial.diagnostics)==vector<DiagnosticKind>{DiagnosticKind::MalformedKey} &&
+                    partial.diagnostics.entries()[0].name=="lib:bad" && partial.code.size()==3;
+                try { malformed.code({},{"lib:bad","lib::st"}); testresult = false; }
+                catch(const SyntaxError&) { }
+
+                IntermediateCode icode;
+                icode.declareForward("lib::func");
+                icode.declareForward("lib::func");
+                icode.closeNamespace();
+                Diagnostics found = icode.diagnose(scheme,{},{"lib::func"},{"void"});
+                testresult = testresult && kinds(found)==vector<DiagnosticKind>{DiagnosticKind::NotFoundModule,
+                    DiagnosticKind::NotFoundKey,DiagnosticKind::DuplicateForward,DiagnosticKind::NamespaceNesting};
+                try { icode.verify(scheme,{},{"lib::func"},{"void"}); testresult = false; }
+                catch(const NotFoundModuleError&) { }
+            }
+            catch(const exception &ex) { testresult=false; emsg=ex.what(); }
+            catch(...) { testresult=false; emsg="Unknown error"; }
+
+            Report(testresult,emsg);
+		}
+
+		TEST_METHOD(sharedCodegen)
+		{
+            bool testresult; string emsg;
+            try
+            {
+                auto version = [](bool with_struct)
+                {
+                    map<LongName,shared_ptr<TypeInfo>> scheme
+                    {
+                       {"std::string",ClassTypeInfo::make("<string>")},
+                       {"lib::func",FunctionTypeInfo::make("",{{"void"},{"std::string"}})},
+                    };
+                    if(with_struct)
+                    {
+                        scheme["lib::st"] = StructTypeInfo::make("");
+                        scheme["lib::func"] = FunctionTypeInfo::make("",{{"void"},{"std::string"},{"lib::st"}});
+                    }
+                    return make_shared<const Codegen>(scheme);
+                };
+                shared_ptr<const Codegen> first = version(false), second = version(true);
+                string first_text = first->source({},{"lib::func"}), second_text = second->source({},{"lib::func"});
+                SharedCodegen shared(first);
+
+                //a reader keeps its version after the publication, the version is dropped when it leaves
+                weak_ptr<const Codegen> replaced = first;
+                {
+                    SharedCodegen::Reader reader = shared.read();
+                    shared.publish(second);
+                    first.reset();
+                    testresult = reader->source({},{"lib::func"})==first_text && shared.retired()==1 &&
+                        !replaced.expired() && shared.source({},{"lib::func"})==second_text;
+                }
+                testresult = testresult && shared.retired()==0 && replaced.expired();
+
+                //the readers see one of the versions while a writer replaces them
+                atomic<bool> torn{false};
+                vector<thread> readers;
+                for(int t=0; t<4; ++t)readers.emplace_back([&]()
+                {
+                    for(int i=0; i<200; ++i)
+                        if(string text = shared.source({},{"lib::func"}); text!=first_text && text!=second_text)torn = true;
+                });
+                for(int i=0; i<100; ++i)shared.publish(version(i%2==0));
+                for(thread &reader : readers)reader.join();
+                shared.publish(second);
+                testresult = testresult && !torn && shared.version()==102 && shared.retired()==0;
+
+                //the readers of the other threads hold the retired versions and leave at once,
+                //the versions are dropped when they have all left
+                vector<weak_ptr<const Codegen>> held;
+                atomic<int> entered{0};
+                atomic<bool> drain{false};
+                vector<thread> holders;
+                for(int t=0; t<4; ++t)
+                {
+                    shared_ptr<const Codegen> next = version(t%2==0);
+                    held.push_back(next);
+                    shared.publish(move(next));
+                    holders.emplace_back([&]()
+                    {
+                        SharedCodegen::Reader reader = shared.read();
+                        ++entered;
+                        while(!drain)this_thread::yield();
+                    });
+                    while(entered<=t)this_thread::yield();
+                }
+                shared.publish(second);
+                testresult = testresult && shared.retired()==4;
+                drain = true;
+                for(thread &holder : holders)holder.join();
+                testresult = testresult && shared.retired()==0 &&
+                    all_of(begin(held),end(held),[](const weak_ptr<const Codegen> &version) { return version.expired(); });
+            }
+            catch(const exception &ex) { testresult=false; emsg=ex.what(); }
+            catch(...) { testresult=false; emsg="Unknown error"; }
+
+            Report(testresult,emsg);
+		}
+
+		TEST_METHOD(sharedCodegenEdits)
+		{
+            bool testresult; string emsg;
+            try
+            {
+                map<LongName,shared_ptr<TypeInfo>> scheme
+                {
+                   {"lib::st",StructTypeInfo::make("")},
+                   {"lib::func",FunctionTypeInfo::make("",{{"void"},{"lib::st"}})},
+                };
+                shared_ptr<const Codegen> first = make_shared<const Codegen>(scheme);
+                string first_text = first->source({},{"lib::func"});
+                scheme["lib::st"] = StructTypeInfo::make("st.h");
+                string second_text = Codegen(scheme).source({},{"lib::func"});
+                size_t names = first->getNames().size();
+                SharedCodegen shared(first);
+
+                //the readers generate while the writer edits copies of the current version and publishes them
+                atomic<bool> done{false}, torn{false};
+                vector<thread> readers;
+                for(int t=0; t<4; ++t)readers.emplace_back([&]()
+                {
+                    while(!done)
+                        if(string text = shared.source({},{"lib::func"}); text!=first_text && text!=second_text)torn = true;
+                });
+                for(int i=0; i<100; ++i)
+                {
+                    auto next = make_shared<Codegen>(*shared.read());
+                    next->replaceType("lib::st",StructTypeInfo::make(i%2==0 ? "st.h" : ""));
+                    next->addType("gen"+to_string(i)+"::func",FunctionTypeInfo::make("",{{"void"},{"lib::st"}}));
+                    shared.publish(move(next));
+                }
+                done = true;
+                for(thread &reader : readers)reader.join();
+                testresult = !torn && shared.source({},{"lib::func"})==first_text &&
+                    shared.read()->getNames().find("gen99::func")!=NoName &&
+                    first->getNames().size()==names && first->source({},{"lib::func"})==first_text;
+            }
+            catch(const exception &ex) { testresult=false; emsg=ex.what(); }
+            catch(...) { testresult=false; emsg="Unknown error"; }
+
             Report(testresult,emsg);
 		}
 